@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/bf.h"
+#include "../include/hp_file_structs.h"
+#include "../include/hp_file_funcs.h"
+
+/*
+ * hp_bench: metrhseis apodoshs tou epipedou HP
+ *
+ *   ./build/hp_bench [-s 10000,100000,...] [-q lookups] [-o results.json] [-T trace]
+ *   ./build/hp_bench -c base.json new.json [-t threshold-percent]
+ *
+ * Gia kathe megethos (plithos eggrafwn) kai kathe politikh (LRU, MRU) metraei:
+ *   - rythmo eisagwghs me HeapFile_InsertRecord (eggrafes apo randomRecord)
+ *   - xrono plhrous sarwshs, me adeio (cold) kai gemato (warm) buffer tou BF
+ *   - kathysterhsh anazhthshs search_id (p50/p99), cold kai warm
+ * Me -T oles oi aithseis blocks grafontai se trace gia to hp_simulate.
+ * Cold shmainei BF_Close/BF_Init prin th metrhsh, dhladh adeio buffer tou BF
+ * (h page cache tou leitourgikou menei opws einai).
+ *
+ * Ta apotelesmata vgainoun se JSON, ena antikeimeno ana grammh sto "results".
+ * Me -c sygkrinontai dyo tetoia arxeia kai to programma epistrefei 1 an kapoia
+ * metrhsh xeirotereuse perissotero apo to orio (default 10%) h an kapoio
+ * apotelesma tou base leipei apo to neo arxeio.
+ */
+
+#define BENCH_FILE_NAME "bench.db"
+#define DEFAULT_SCALES "10000,100000,1000000"
+#define DEFAULT_LOOKUPS 100
+#define MIN_P99_LOOKUPS 100  // me ligotera deigmata to "p99" einai sthn ousia to max
+#define INSERT_BATCH 4096
+#define MAX_SCALES 16
+#define MAX_RESULTS 64
+#define MAX_METRICS 16
+
+#define CALL_OR_DIE(call)     \
+  {                           \
+    BF_ErrorCode code = call; \
+    if (code != BF_OK) {      \
+      BF_PrintError(code);    \
+      exit(code);             \
+    }                         \
+  }
+
+typedef struct BenchResult {
+  long long rows;
+  const char* policy;
+  double insert_rows_per_sec;
+  double scan_cold_ms;
+  double scan_warm_ms;
+  double lookup_cold_p50_us;
+  double lookup_cold_p99_us;
+  double lookup_warm_p50_us;
+  double lookup_warm_p99_us;
+} BenchResult;
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile(double* values, int n, int p)
+{
+  qsort(values, n, sizeof(double), cmp_double);
+  return values[(n - 1) * p / 100];
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 metrhseis                                  */
+/* -------------------------------------------------------------------------- */
+
+typedef struct BenchFile {
+  int file_handle;
+  HeapFileHeader* header_info;
+  ReplacementAlgorithm repl;
+} BenchFile;
+
+static void bench_open(BenchFile* f)
+{
+  CALL_OR_DIE(BF_Init(f->repl));
+  if (!HeapFile_Open(BENCH_FILE_NAME, &f->file_handle, &f->header_info)) {
+    fprintf(stderr, "cannot open %s\n", BENCH_FILE_NAME);
+    exit(1);
+  }
+}
+
+static void bench_close(BenchFile* f)
+{
+  HeapFile_Close(f->file_handle, f->header_info);
+  CALL_OR_DIE(BF_Close());
+}
+
+// ksanaanoigei to arxeio me adeio buffer tou BF
+static void bench_drop_cache(BenchFile* f)
+{
+  bench_close(f);
+  bench_open(f);
+}
+
+static double bench_insert(BenchFile* f, long long rows)
+{
+  static Record batch[INSERT_BATCH];
+  double elapsed = 0;
+  srand(12569874);
+  for (long long done = 0; done < rows;) {
+    int n = rows - done < INSERT_BATCH ? (int)(rows - done) : INSERT_BATCH;
+    // h paragwgh twn eggrafwn den metraei ston xrono eisagwghs
+    for (int i = 0; i < n; i++) batch[i] = randomRecord();
+    double start = now_seconds();
+    for (int i = 0; i < n; i++) {
+      if (!HeapFile_InsertRecord(f->file_handle, f->header_info, batch[i])) {
+        fprintf(stderr, "insert failed after %lld records\n", done + i);
+        exit(1);
+      }
+    }
+    elapsed += now_seconds() - start;
+    done += n;
+  }
+  return elapsed > 0 ? rows / elapsed : 0;
+}
+
+// sarwsh me to iterator, epistrefei ton xrono se seconds
+static double bench_scan(BenchFile* f, int search_id, long long* found)
+{
+  double start = now_seconds();
+  HeapFileIterator it = HeapFile_CreateIterator(f->file_handle, f->header_info, search_id);
+  Record* rec;
+  long long n = 0;
+  while (HeapFile_GetNextRecord(&it, &rec)) {
+    free(rec);
+    n++;
+  }
+  double elapsed = now_seconds() - start;
+  if (found) *found = n;
+  return elapsed;
+}
+
+static void bench_lookups(BenchFile* f, int lookups, int cold, double* p50, double* p99)
+{
+  double* lat = malloc(lookups * sizeof(double));
+  srand(4242);
+  for (int q = 0; q < lookups; q++) {
+    if (cold) bench_drop_cache(f);
+    lat[q] = bench_scan(f, rand() % 1000, NULL) * 1e6;
+  }
+  *p50 = percentile(lat, lookups, 50);
+  *p99 = percentile(lat, lookups, 99);
+  free(lat);
+}
+
+static void bench_run(long long rows, ReplacementAlgorithm repl, int lookups, BenchResult* r)
+{
+  BenchFile f;
+  f.repl = repl;
+  r->rows = rows;
+  r->policy = repl == LRU ? "LRU" : "MRU";
+
+  unlink(BENCH_FILE_NAME);
+  CALL_OR_DIE(BF_Init(repl));
+  if (!HeapFile_Create(BENCH_FILE_NAME)) exit(1);
+  CALL_OR_DIE(BF_Close());
+
+  bench_open(&f);
+  r->insert_rows_per_sec = bench_insert(&f, rows);
+
+  long long found;
+  bench_drop_cache(&f);
+  r->scan_cold_ms = bench_scan(&f, -1, &found) * 1e3;
+  if (found != rows) {
+    fprintf(stderr, "scan returned %lld of %lld records\n", found, rows);
+    exit(1);
+  }
+  r->scan_warm_ms = bench_scan(&f, -1, NULL) * 1e3;
+
+  bench_lookups(&f, lookups, 1, &r->lookup_cold_p50_us, &r->lookup_cold_p99_us);
+  bench_lookups(&f, lookups, 0, &r->lookup_warm_p50_us, &r->lookup_warm_p99_us);
+
+  bench_close(&f);
+  unlink(BENCH_FILE_NAME);
+}
+
+static void write_json(FILE* out, BenchResult* results, int n, int lookups)
+{
+  fprintf(out, "{\n  \"benchmark\": \"hp_bench\",\n");
+  fprintf(out, "  \"block_size\": %d, \"buffer_blocks\": %d, \"record_size\": %zu, \"lookups\": %d,\n",
+          BF_BLOCK_SIZE, BF_BUFFER_SIZE, sizeof(Record), lookups);
+  fprintf(out, "  \"results\": [\n");
+  for (int i = 0; i < n; i++) {
+    BenchResult* r = &results[i];
+    fprintf(out,
+            "    {\"rows\": %lld, \"policy\": \"%s\", \"insert_rows_per_sec\": %.0f, "
+            "\"scan_cold_ms\": %.3f, \"scan_warm_ms\": %.3f, "
+            "\"lookup_cold_p50_us\": %.1f, \"lookup_cold_p99_us\": %.1f, "
+            "\"lookup_warm_p50_us\": %.1f, \"lookup_warm_p99_us\": %.1f}%s\n",
+            r->rows, r->policy, r->insert_rows_per_sec, r->scan_cold_ms, r->scan_warm_ms,
+            r->lookup_cold_p50_us, r->lookup_cold_p99_us, r->lookup_warm_p50_us,
+            r->lookup_warm_p99_us, i + 1 < n ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  sygkrish                                  */
+/* -------------------------------------------------------------------------- */
+
+typedef struct ParsedResult {
+  char key[64];  // "rows/policy"
+  int n;
+  char names[MAX_METRICS][32];
+  double values[MAX_METRICS];
+} ParsedResult;
+
+// diavazei mono oti grafei to write_json: mia grammh ana apotelesma
+static int parse_results(const char* path, ParsedResult* out, int max)
+{
+  FILE* in = fopen(path, "r");
+  if (in == NULL) {
+    perror(path);
+    exit(1);
+  }
+  char line[1024];
+  int n = 0;
+  while (n < max && fgets(line, sizeof(line), in)) {
+    if (strstr(line, "\"rows\"") == NULL) continue;
+    ParsedResult* r = &out[n];
+    char rows[32] = "", policy[16] = "";
+    r->n = 0;
+    char* p = line;
+    while ((p = strchr(p, '"')) != NULL) {
+      char name[32];
+      char* e = strchr(p + 1, '"');
+      if (e == NULL || e - p - 1 >= (long)sizeof(name)) break;
+      memcpy(name, p + 1, e - p - 1);
+      name[e - p - 1] = '\0';
+      p = e + 1;
+      if (*p != ':') continue;
+      p++;
+      while (*p == ' ') p++;
+      if (*p == '"') {
+        e = strchr(p + 1, '"');
+        if (e == NULL) break;
+        if (strcmp(name, "policy") == 0 && e - p - 1 < (long)sizeof(policy)) {
+          memcpy(policy, p + 1, e - p - 1);
+          policy[e - p - 1] = '\0';
+        }
+        p = e + 1;
+      } else {
+        double v = strtod(p, &e);
+        if (strcmp(name, "rows") == 0)
+          snprintf(rows, sizeof(rows), "%.0f", v);
+        else if (r->n < MAX_METRICS) {
+          strcpy(r->names[r->n], name);
+          r->values[r->n++] = v;
+        }
+        p = e;
+      }
+    }
+    snprintf(r->key, sizeof(r->key), "%s/%s", rows, policy);
+    n++;
+  }
+  fclose(in);
+  return n;
+}
+
+static int compare(const char* base_path, const char* new_path, double threshold)
+{
+  static ParsedResult base[MAX_RESULTS], cur[MAX_RESULTS];
+  int nb = parse_results(base_path, base, MAX_RESULTS);
+  int nc = parse_results(new_path, cur, MAX_RESULTS);
+  int regressions = 0, missing = 0;
+
+  printf("%-16s %-22s %14s %14s %9s\n", "rows/policy", "metric", "base", "new", "change");
+  for (int i = 0; i < nc; i++) {
+    ParsedResult* b = NULL;
+    for (int j = 0; j < nb; j++)
+      if (strcmp(base[j].key, cur[i].key) == 0) b = &base[j];
+    if (b == NULL) continue;
+    for (int m = 0; m < cur[i].n; m++) {
+      for (int k = 0; k < b->n; k++) {
+        if (strcmp(b->names[k], cur[i].names[m]) != 0 || b->values[k] == 0) continue;
+        double change = (cur[i].values[m] - b->values[k]) / b->values[k] * 100;
+        // mono o rythmos eisagwghs einai "megalytero = kalytero"
+        int higher_is_better = strstr(cur[i].names[m], "per_sec") != NULL;
+        int regressed = higher_is_better ? change < -threshold : change > threshold;
+        regressions += regressed;
+        printf("%-16s %-22s %14.3f %14.3f %+8.1f%%%s\n", cur[i].key, cur[i].names[m],
+               b->values[k], cur[i].values[m], change, regressed ? "  REGRESSION" : "");
+      }
+    }
+  }
+  // ena apotelesma pou xathike (p.x. crash se kapoio megethos) metraei ws apotyxia
+  for (int j = 0; j < nb; j++) {
+    int found = 0;
+    for (int i = 0; i < nc && !found; i++) found = strcmp(base[j].key, cur[i].key) == 0;
+    if (!found) {
+      missing++;
+      printf("%-16s %-22s %14s %14s %9s  MISSING\n", base[j].key, "-", "-", "-", "-");
+    }
+  }
+  printf("%d regression(s) over %.1f%%, %d missing result(s)\n", regressions, threshold, missing);
+  return regressions > 0 || missing > 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void usage(const char* prog)
+{
+  fprintf(stderr,
+          "usage: %s [-s rows,rows,...] [-q lookups] [-o results.json] [-T trace]\n"
+          "       %s -c base.json new.json [-t threshold-percent]\n", prog, prog);
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  const char* scales = DEFAULT_SCALES;
+  const char* output = NULL;
+  const char* trace_name = NULL;
+  int lookups = DEFAULT_LOOKUPS;
+  int compare_mode = 0;
+  double threshold = 10;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:q:o:ct:T:")) != -1) {
+    switch (opt) {
+      case 's': scales = optarg; break;
+      case 'q': lookups = atoi(optarg); break;
+      case 'o': output = optarg; break;
+      case 'T': trace_name = optarg; break;
+      case 'c': compare_mode = 1; break;
+      case 't': threshold = atof(optarg); break;
+      default: usage(argv[0]);
+    }
+  }
+  if (compare_mode) {
+    if (argc - optind != 2) usage(argv[0]);
+    return compare(argv[optind], argv[optind + 1], threshold);
+  }
+  if (optind != argc || lookups < 1) usage(argv[0]);
+  if (lookups < MIN_P99_LOOKUPS)
+    fprintf(stderr, "warning: %d lookups are too few for p99, the reported value is close to the max\n",
+            lookups);
+
+  long long rows[MAX_SCALES];
+  int nscales = 0;
+  for (const char* p = scales; *p && nscales < MAX_SCALES;) {
+    char* e;
+    rows[nscales] = strtoll(p, &e, 10);
+    if (e == p || rows[nscales] <= 0) usage(argv[0]);
+    nscales++;
+    p = *e == ',' ? e + 1 : e;
+  }
+
+  if (trace_name && !HeapFile_TraceStart(trace_name)) {
+    perror(trace_name);
+    return 1;
+  }
+
+  static BenchResult results[MAX_RESULTS];
+  int n = 0;
+  ReplacementAlgorithm policies[] = {LRU, MRU};
+  for (int s = 0; s < nscales; s++) {
+    for (int p = 0; p < 2; p++) {
+      BenchResult* r = &results[n++];
+      bench_run(rows[s], policies[p], lookups, r);
+      fprintf(stderr, "%lld rows %s: insert %.0f rows/s, scan cold %.1f ms warm %.1f ms, "
+              "lookup p50/p99 cold %.0f/%.0f us warm %.0f/%.0f us\n",
+              r->rows, r->policy, r->insert_rows_per_sec, r->scan_cold_ms, r->scan_warm_ms,
+              r->lookup_cold_p50_us, r->lookup_cold_p99_us, r->lookup_warm_p50_us, r->lookup_warm_p99_us);
+    }
+  }
+
+  if (trace_name) HeapFile_TraceStop();
+
+  FILE* out = output ? fopen(output, "w") : stdout;
+  if (out == NULL) {
+    perror(output);
+    return 1;
+  }
+  write_json(out, results, n, lookups);
+  if (out != stdout) fclose(out);
+  return 0;
+}
@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/bf.h"
+#include "../include/hp_file_structs.h"
+#include "../include/hp_file_funcs.h"
+
+/*
+ * hp_import: fortwsh eggrafwn se heap file apo CSV h apo binary dump (Record)
+ *
+ *   ./build/hp_import [-b] [-m] [-T trace] <heap-file> [input-file | -]
+ *
+ *   -b   to input einai raw binary dump apo structs Record (default: CSV)
+ *   -m   xrhsh MRU anti gia LRU sto BF_Init
+ *   -T   katagrafh twn aithsewn blocks sto arxeio trace (gia to hp_simulate)
+ *
+ * CSV: mia eggrafh ana grammh "id,name,surname,city". Mia prwth grammh pou
+ * den ksekinaei me arithmo theoreitai epikefalida kai agnoeitai. Pedia se
+ * eisagwgika (RFC 4180, opws ta grafei to hp_export) mporoun na exoun ',', '"'
+ * kai allages grammhs. Grammes me allo plithos pediwn, me id pou den xwraei
+ * se int h me pedio megalytero apo to Record aporriptontai kai metrane.
+ *
+ * Ena nhma (parser) diavazei kai gemizei batches se ena ring buffer, kai ena
+ * deytero (loader) ta grafei sta blocks me HeapFile_InsertRecords. To header
+ * grafetai meta apo kathe batch, wste ena import pou apotygxanei sth mesh na
+ * afhnei arxeio me ola ta blocks twn prohgoumenwn batches. H mnhmh einai statherh (RING_SLOTS * BATCH_RECORDS
+ * eggrafes + to buffer anagnwshs), opote douleyei kai gia arxeia megalytera apo th RAM.
+ */
+
+#define BATCH_RECORDS 4096
+#define RING_SLOTS 8
+#define READ_BUF_SIZE (1 << 16)
+
+#define CALL_OR_DIE(call)     \
+  {                           \
+    BF_ErrorCode code = call; \
+    if (code != BF_OK) {      \
+      BF_PrintError(code);    \
+      exit(code);             \
+    }                         \
+  }
+
+typedef struct Batch {
+  Record records[BATCH_RECORDS];
+  int count;
+} Batch;
+
+typedef struct Ring {
+  Batch slots[RING_SLOTS];
+  int head;  // epomeno slot pou tha gemisei o parser
+  int tail;  // epomeno slot pou tha adeiasei o loader
+  int full;  // posa slots einai etoima gia ton loader
+  int done;  // o parser teleiwse
+  pthread_mutex_t lock;
+  pthread_cond_t not_full;
+  pthread_cond_t not_empty;
+} Ring;
+
+typedef struct ImportArgs {
+  Ring* ring;
+  FILE* in;
+  int binary;
+  long long rows;
+  long long bad_rows;
+  size_t trailing_bytes;
+  int read_errno;  // 0 an to input diavasthke mexri to EOF
+  int file_handle;
+  HeapFileHeader* header_info;
+  int ok;
+} ImportArgs;
+
+static Ring ring;
+
+/* -------------------------------------------------------------------------- */
+/*                                ring buffer                                 */
+/* -------------------------------------------------------------------------- */
+
+static Batch* ring_acquire_empty(Ring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  while (r->full == RING_SLOTS)
+    pthread_cond_wait(&r->not_full, &r->lock);
+  Batch* b = &r->slots[r->head];
+  pthread_mutex_unlock(&r->lock);
+  b->count = 0;
+  return b;
+}
+
+static void ring_publish(Ring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  r->head = (r->head + 1) % RING_SLOTS;
+  r->full += 1;
+  pthread_cond_signal(&r->not_empty);
+  pthread_mutex_unlock(&r->lock);
+}
+
+static void ring_finish(Ring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  r->done = 1;
+  pthread_cond_signal(&r->not_empty);
+  pthread_mutex_unlock(&r->lock);
+}
+
+// epistrefei NULL otan o parser exei teleiwsei kai den exei meinei tipota
+static Batch* ring_acquire_full(Ring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  while (r->full == 0 && !r->done)
+    pthread_cond_wait(&r->not_empty, &r->lock);
+  Batch* b = r->full == 0 ? NULL : &r->slots[r->tail];
+  pthread_mutex_unlock(&r->lock);
+  return b;
+}
+
+static void ring_release(Ring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  r->tail = (r->tail + 1) % RING_SLOTS;
+  r->full -= 1;
+  pthread_cond_signal(&r->not_full);
+  pthread_mutex_unlock(&r->lock);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  parsing                                   */
+/* -------------------------------------------------------------------------- */
+
+// ena pedio apo to p mexri to epomeno ',' h to end, sto dst me '\0' sto telos.
+// Pedio se eisagwgika (RFC 4180) mporei na exei ',' kai allagh grammhs, kai to "" ginetai '"'.
+// Epistrefei th thesh meta to pedio (',' h end), h NULL an to pedio einai lathos h den
+// xwraei sto dst (den to kovoume, gia na mhn allaksei h eggrafh xwris mhnyma)
+static const char* parse_field(const char* p, const char* end, char* dst, int size)
+{
+  int n = 0;
+  if (p < end && *p == '"') {
+    for (p++;; p++) {
+      if (p == end) return NULL;  // den ekleise to eisagwgiko
+      if (*p == '"') {
+        if (p + 1 == end || p[1] != '"') break;
+        p++;
+      }
+      if (n == size - 1) return NULL;
+      dst[n++] = *p;
+    }
+    p++;
+    if (p < end && *p != ',') return NULL;
+  } else {
+    const char* s = p;
+    while (p < end && *p != ',') p++;
+    if (p - s > size - 1) return NULL;
+    n = (int)(p - s);
+    memcpy(dst, s, n);
+  }
+  memset(dst + n, 0, size - n);
+  return p;
+}
+
+// "id,name,surname,city" -> record. Epistrefei 1 an h grammh htan egkyrh
+static int parse_csv_line(const char* s, const char* end, Record* rec)
+{
+  // agnooume '\r' apo arxeia windows
+  if (end > s && end[-1] == '\r') end--;
+
+  // to id den grafetai pote se eisagwgika
+  const char* id_end = memchr(s, ',', end - s);
+  if (id_end == NULL) return 0;
+  const char* q = s;
+  int neg = 0;
+  if (q < id_end && *q == '-') { neg = 1; q++; }
+  if (q == id_end) return 0;
+  long long id = 0;
+  for (; q < id_end; q++) {
+    if (*q < '0' || *q > '9') return 0;
+    id = id * 10 + (*q - '0');
+    if (id > (long long)INT_MAX + neg) return 0;  // den xwraei se int
+  }
+  rec->id = (int)(neg ? -id : id);
+
+  const char* p = parse_field(id_end + 1, end, rec->name, sizeof(rec->name));
+  if (p == NULL || p == end) return 0;
+  p = parse_field(p + 1, end, rec->surname, sizeof(rec->surname));
+  if (p == NULL || p == end) return 0;
+  p = parse_field(p + 1, end, rec->city, sizeof(rec->city));
+  // ligotera h perissotera apo 4 pedia: h grammh aporriptetai olh
+  return p == end;
+}
+
+// to '\n' pou kleinei thn eggrafh apo to p, agnoontas ta '\n' mesa se eisagwgika.
+// NULL an h eggrafh synexizetai meta to end
+static char* find_line_end(char* p, char* end)
+{
+  char* nl = memchr(p, '\n', end - p);
+  if (nl == NULL || memchr(p, '"', nl - p) == NULL) return nl;
+  int quoted = 0;
+  for (; p < end; p++) {
+    if (*p == '"') quoted = !quoted;
+    else if (*p == '\n' && !quoted) return p;
+  }
+  return NULL;
+}
+
+static void parse_csv(ImportArgs* args)
+{
+  static char buf[READ_BUF_SIZE];
+  size_t len = 0;
+  int first_line = 1;
+  int skipping = 0;  // petame ena kommati apo grammh pou den xwrese sto buffer
+  int eof = 0;
+  Batch* batch = ring_acquire_empty(args->ring);
+
+  while (!eof || len > 0) {
+    if (!eof) {
+      size_t n = fread(buf + len, 1, sizeof(buf) - len, args->in);
+      if (n == 0) {
+        eof = 1;
+        if (ferror(args->in)) args->read_errno = errno ? errno : EIO;
+      }
+      len += n;
+    }
+    char* p = buf;
+    char* end = buf + len;
+    for (;;) {
+      char* nl = skipping ? memchr(p, '\n', end - p) : find_line_end(p, end);
+      if (skipping) {
+        // to ypoloipo ths grammhs pou aporripsame, mexri to epomeno '\n'
+        if (nl == NULL) {
+          p = end;
+          break;
+        }
+        skipping = 0;
+        p = nl + 1;
+        continue;
+      }
+      if (nl == NULL) {
+        // teleutaia grammh xwris '\n' sto telos tou arxeiou
+        if (eof && p < end) nl = end;
+        else break;
+      }
+      // oi adeies grammes agnoountai
+      if (nl > p) {
+        if (parse_csv_line(p, nl, &batch->records[batch->count])) {
+          if (++batch->count == BATCH_RECORDS) {
+            args->rows += batch->count;
+            ring_publish(args->ring);
+            batch = ring_acquire_empty(args->ring);
+          }
+        } else if (!first_line) {
+          args->bad_rows++;
+        }
+        first_line = 0;
+      }
+      p = nl < end ? nl + 1 : end;
+    }
+    len = end - p;
+    if (len == sizeof(buf)) {
+      // h grammh den xwraei sto buffer, thn aporriptoume olh
+      args->bad_rows++;
+      first_line = 0;
+      skipping = 1;
+      len = 0;
+    } else if (len > 0) {
+      memmove(buf, p, len);
+    }
+    if (eof && p == end) len = 0;
+  }
+
+  args->rows += batch->count;
+  if (batch->count > 0) ring_publish(args->ring);
+}
+
+static void parse_binary(ImportArgs* args)
+{
+  const size_t batch_bytes = BATCH_RECORDS * sizeof(Record);
+  for (;;) {
+    Batch* batch = ring_acquire_empty(args->ring);
+    // diavazoume se bytes gia na kseroume an emeine miso Record sto telos
+    size_t bytes = 0, n;
+    while (bytes < batch_bytes &&
+           (n = fread((char*)batch->records + bytes, 1, batch_bytes - bytes, args->in)) > 0)
+      bytes += n;
+    batch->count = (int)(bytes / sizeof(Record));
+    args->rows += batch->count;
+    if (batch->count > 0) ring_publish(args->ring);
+    if (bytes < batch_bytes) {
+      if (ferror(args->in)) {
+        args->read_errno = errno ? errno : EIO;
+        break;
+      }
+      // kommeno arxeio: to teleutaio, miso Record aporriptetai
+      args->trailing_bytes = bytes % sizeof(Record);
+      if (args->trailing_bytes > 0) args->bad_rows++;
+      break;
+    }
+  }
+}
+
+static void* parser_thread(void* p)
+{
+  ImportArgs* args = p;
+  if (args->binary) parse_binary(args);
+  else parse_csv(args);
+  ring_finish(args->ring);
+  return NULL;
+}
+
+static void* loader_thread(void* p)
+{
+  ImportArgs* args = p;
+  Batch* batch;
+  while ((batch = ring_acquire_full(args->ring)) != NULL) {
+    // meta thn prwth apotyxia synexizoume na adeiazoume to ring gia na mhn kollhsei o parser
+    if (args->ok) {
+      args->ok = HeapFile_InsertRecords(args->file_handle, args->header_info, batch->records, batch->count);
+      // kai meta apo apotyxia: to header krataei osa blocks prolavan na graftoun
+      if (!HeapFile_FlushHeader(args->file_handle, args->header_info)) args->ok = 0;
+    }
+    ring_release(args->ring);
+  }
+  return NULL;
+}
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-b] [-m] [-T trace] <heap-file> [input-file | -]\n", prog);
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  int binary = 0;
+  ReplacementAlgorithm repl = LRU;
+  const char* trace_name = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "bmT:")) != -1) {
+    switch (opt) {
+      case 'b': binary = 1; break;
+      case 'm': repl = MRU; break;
+      case 'T': trace_name = optarg; break;
+      default: usage(argv[0]);
+    }
+  }
+  if (optind >= argc || argc - optind > 2) usage(argv[0]);
+  const char* heap_name = argv[optind];
+  const char* input_name = optind + 1 < argc ? argv[optind + 1] : "-";
+
+  FILE* in = strcmp(input_name, "-") == 0 ? stdin : fopen(input_name, binary ? "rb" : "r");
+  if (in == NULL) {
+    perror(input_name);
+    return 1;
+  }
+
+  if (trace_name && !HeapFile_TraceStart(trace_name)) {
+    perror(trace_name);
+    return 1;
+  }
+  CALL_OR_DIE(BF_Init(repl));
+  // an to heap file den yparxei to dhmiourgoume, alliws prosthetoume sto telos tou
+  if (access(heap_name, F_OK) != 0 && !HeapFile_Create(heap_name)) {
+    fprintf(stderr, "cannot create heap file %s\n", heap_name);
+    return 1;
+  }
+
+  ImportArgs args;
+  memset(&args, 0, sizeof(args));
+  args.ring = &ring;
+  args.in = in;
+  args.binary = binary;
+  args.ok = 1;
+  if (!HeapFile_Open(heap_name, &args.file_handle, &args.header_info)) {
+    fprintf(stderr, "cannot open heap file %s\n", heap_name);
+    return 1;
+  }
+
+  pthread_mutex_init(&ring.lock, NULL);
+  pthread_cond_init(&ring.not_full, NULL);
+  pthread_cond_init(&ring.not_empty, NULL);
+
+  double start = now_seconds();
+  pthread_t parser, loader;
+  pthread_create(&parser, NULL, parser_thread, &args);
+  pthread_create(&loader, NULL, loader_thread, &args);
+  pthread_join(parser, NULL);
+  pthread_join(loader, NULL);
+  double elapsed = now_seconds() - start;
+
+  HeapFile_Close(args.file_handle, args.header_info);
+  CALL_OR_DIE(BF_Close());
+  if (trace_name) HeapFile_TraceStop();
+  if (in != stdin) fclose(in);
+
+  if (args.read_errno != 0)
+    fprintf(stderr, "%s: read error: %s\n", input_name, strerror(args.read_errno));
+  if (args.trailing_bytes > 0)
+    fprintf(stderr, "Input ends with a partial record: %zu trailing bytes ignored\n", args.trailing_bytes);
+  fprintf(stderr, "Imported %lld records (%lld rejected) in %.3f s: %.0f rows/s\n",
+          args.rows, args.bad_rows, elapsed, elapsed > 0 ? args.rows / elapsed : 0.0);
+
+  // mono an h vivliothhkh exei ginei build me METRICS=1 h METRICS=timing
+  HeapFileMetrics metrics;
+  if (HeapFile_GetMetrics(&metrics)) HeapFile_DumpMetrics(stderr, 0);
+  return args.ok && args.read_errno == 0 ? 0 : 1;
+}
@@ -0,0 +1,523 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include "../include/bf.h"
+#include "../include/hp_file_structs.h"
+
+/*
+ * hp_simulate: ksanapaizei ena trace apo HeapFile_TraceStart panw se diafores
+ * politikes antikatastashs kai megethh buffer kai typwnei to hit rate.
+ *
+ *   ./build/hp_simulate [-p 10,25,50,100,...] <trace-file>
+ *
+ * Politikes: LRU, MRU (opws sto BF), CLOCK, 2Q (Johnson & Shasha, Kin = P/4,
+ * Kout = P/2) kai OPT (Belady, to veltisto dynato).
+ * Ta blocks pou desmeuontai (HP_TRACE_ALLOCATE) mpainoun sto buffer alla den
+ * metrane san hit h miss, afou den diavazontai apo to disko. Sto HP_TRACE_CLOSE
+ * ola ta blocks tou arxeiou vgainoun apo to buffer (opws sto BF_CloseFile) kai
+ * meta to ksananoigma einai nea blocks, wste ena arxeio pou ksanadhmiourgeitai
+ * h ksanadiavazetai cold na mhn metraei hits apo thn prohgoumenh fora.
+ * Ta pins den prosomoiwnontai: to BF den mporei na dwsei block pou einai
+ * pinned, alla to HP krataei to poly dyo pinned ana fora.
+ * Olo to trace fortwnetai sth mnhmh (peripou 32 bytes ana aithsh sto OPT). An
+ * den xwraei, to programma stamataei me mhnyma.
+ */
+
+#define DEFAULT_POOLS "10,25,50,100,200,400,800"
+#define MAX_POOLS 32
+#define NIL (-1)
+#define EVICT (-1)
+#define NEVER SIZE_MAX  // thesh sto trace gia "den einai sto buffer" (OPT)
+
+typedef struct Access {
+  int id;      // pykno id tou block (0..distinct-1)
+  int counts;  // 1 gia anagnwsh/eggrafh, 0 gia allocations, EVICT an to block vgainei apo to buffer
+} Access;
+
+typedef struct Trace {
+  Access* acc;
+  size_t n;  // aithseis kai EVICT mazi
+  int distinct;
+  long long reads, writes, scans, points, allocs, closes;
+} Trace;
+
+// olo to trace krataei sth mnhmh: an den xwraei stamatame me mhnyma anti gia overflow h NULL
+static void* xalloc(void* p, size_t count, size_t size)
+{
+  void* q = count <= SIZE_MAX / size ? realloc(p, count * size) : NULL;
+  if (q == NULL && count > 0) {
+    fprintf(stderr, "out of memory: the trace is too large to simulate (%zu x %zu bytes)\n", count, size);
+    exit(1);
+  }
+  return q;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                         fortwsh kai pykna ids blocks                         */
+/* -------------------------------------------------------------------------- */
+
+typedef struct KeyMap {
+  unsigned long long* keys;
+  int* ids;
+  size_t cap;
+} KeyMap;
+
+static size_t key_slot(const KeyMap* m, unsigned long long key)
+{
+  unsigned long long h = key * 0x9E3779B97F4A7C15ULL;
+  size_t i = (size_t)(h >> 20) & (m->cap - 1);
+  while (m->ids[i] != NIL && m->keys[i] != key) i = (i + 1) & (m->cap - 1);
+  return i;
+}
+
+static void keymap_grow(KeyMap* m)
+{
+  KeyMap old = *m;
+  m->cap = old.cap ? old.cap * 2 : 1024;
+  m->keys = xalloc(NULL, m->cap, sizeof(*m->keys));
+  m->ids = xalloc(NULL, m->cap, sizeof(*m->ids));
+  for (size_t i = 0; i < m->cap; i++) m->ids[i] = NIL;
+  for (size_t i = 0; i < old.cap; i++) {
+    if (old.ids[i] == NIL) continue;
+    size_t j = key_slot(m, old.keys[i]);
+    m->keys[j] = old.keys[i];
+    m->ids[j] = old.ids[i];
+  }
+  free(old.keys);
+  free(old.ids);
+}
+
+// ta blocks kathe arxeiou apo to teleutaio anoigma tou, gia na ta vgaloume sto close
+typedef struct TraceFile {
+  unsigned int name_hash;
+  unsigned int instance;
+  int* ids;
+  size_t n, cap;
+} TraceFile;
+
+static void trace_push(Trace* t, size_t* cap, int id, int counts)
+{
+  if (t->n == *cap) {
+    *cap *= 2;
+    t->acc = xalloc(t->acc, *cap, sizeof(Access));
+  }
+  t->acc[t->n].id = id;
+  t->acc[t->n].counts = counts;
+  t->n++;
+}
+
+static Trace load_trace(const char* path)
+{
+  FILE* in = fopen(path, "rb");
+  if (in == NULL) {
+    perror(path);
+    exit(1);
+  }
+  HeapFileTraceHeader header;
+  if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, HP_TRACE_MAGIC, 4) != 0 ||
+      header.version != HP_TRACE_VERSION || header.entry_size != sizeof(HeapFileTraceEntry)) {
+    fprintf(stderr, "%s: not a heap file trace\n", path);
+    exit(1);
+  }
+
+  Trace t;
+  memset(&t, 0, sizeof(t));
+  size_t cap = 1 << 16;
+  t.acc = xalloc(NULL, cap, sizeof(Access));
+  KeyMap map = {NULL, NULL, 0};
+  keymap_grow(&map);
+  // to BF ksanaxrhsimopoiei ta handles, opote kratame poio arxeio antistoixei se kathe handle.
+  // Ta kleidia einai (instance, block), me neo instance se kathe close tou arxeiou.
+  static int file_of_handle[1 << 16];
+  for (int i = 0; i < (1 << 16); i++) file_of_handle[i] = NIL;
+  TraceFile* files = NULL;
+  int nfiles = 0;
+  unsigned int instances = 0;
+
+  HeapFileTraceEntry buf[4096];
+  size_t got;
+  while ((got = fread(buf, sizeof(HeapFileTraceEntry), 4096, in)) > 0) {
+    for (size_t k = 0; k < got; k++) {
+      HeapFileTraceEntry* e = &buf[k];
+      int* fidx = &file_of_handle[e->file_handle];
+      if ((e->flags & HP_TRACE_OPEN) || *fidx == NIL) {
+        // handle xwris OPEN (to trace ksekinhse me anoixto arxeio): to handle ginetai to onoma
+        unsigned int hash = e->flags & HP_TRACE_OPEN ? e->block_num : e->file_handle;
+        for (*fidx = 0; *fidx < nfiles && files[*fidx].name_hash != hash; (*fidx)++);
+        if (*fidx == nfiles) {
+          files = xalloc(files, ++nfiles, sizeof(TraceFile));
+          files[*fidx] = (TraceFile){hash, instances++, NULL, 0, 0};
+        }
+        if (e->flags & HP_TRACE_OPEN) continue;
+      }
+      TraceFile* f = &files[*fidx];
+      if (e->flags & HP_TRACE_CLOSE) {
+        for (size_t i = 0; i < f->n; i++) trace_push(&t, &cap, f->ids[i], EVICT);
+        f->n = 0;
+        f->instance = instances++;
+        t.closes++;
+        continue;
+      }
+      unsigned long long key = (unsigned long long)f->instance << 32 | e->block_num;
+      if ((size_t)t.distinct * 2 >= map.cap) keymap_grow(&map);
+      size_t slot = key_slot(&map, key);
+      if (map.ids[slot] != NIL && (e->flags & HP_TRACE_ALLOCATE)) {
+        // neo block sth thesh enos palioterou (p.x. arxeio pou ksanadhmiourghthke xwris close)
+        trace_push(&t, &cap, map.ids[slot], EVICT);
+        map.ids[slot] = NIL;
+      }
+      if (map.ids[slot] == NIL) {
+        if (t.distinct == INT_MAX) {
+          fprintf(stderr, "%s: too many distinct blocks to simulate\n", path);
+          exit(1);
+        }
+        map.keys[slot] = key;
+        map.ids[slot] = t.distinct++;
+        if (f->n == f->cap) {
+          f->cap = f->cap ? f->cap * 2 : 1024;
+          f->ids = xalloc(f->ids, f->cap, sizeof(int));
+        }
+        f->ids[f->n++] = map.ids[slot];
+      }
+      trace_push(&t, &cap, map.ids[slot], !(e->flags & HP_TRACE_ALLOCATE));
+      if (e->flags & HP_TRACE_ALLOCATE) t.allocs++;
+      else if (e->flags & HP_TRACE_WRITE) t.writes++;
+      else t.reads++;
+      if (e->flags & HP_TRACE_SCAN) t.scans++;
+      else t.points++;
+    }
+  }
+  fclose(in);
+  for (int i = 0; i < nfiles; i++) free(files[i].ids);
+  free(files);
+  free(map.keys);
+  free(map.ids);
+  return t;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              lists panw se ids                             */
+/* -------------------------------------------------------------------------- */
+
+// kathe id anhkei to poly se mia lista ana fora, opote arkoun koinoi pinakes prev/next
+typedef struct List {
+  int head, tail, size;
+} List;
+
+static int* prev_of;
+static int* next_of;
+
+static void list_init(List* l) { l->head = l->tail = NIL; l->size = 0; }
+
+static void list_push_front(List* l, int id)
+{
+  prev_of[id] = NIL;
+  next_of[id] = l->head;
+  if (l->head != NIL) prev_of[l->head] = id;
+  else l->tail = id;
+  l->head = id;
+  l->size++;
+}
+
+static void list_remove(List* l, int id)
+{
+  if (prev_of[id] != NIL) next_of[prev_of[id]] = next_of[id];
+  else l->head = next_of[id];
+  if (next_of[id] != NIL) prev_of[next_of[id]] = prev_of[id];
+  else l->tail = prev_of[id];
+  l->size--;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 politikes                                  */
+/* -------------------------------------------------------------------------- */
+
+// LRU kai MRU: lista apo to pio prosfato (head) sto pio palio (tail)
+static long long sim_recency(const Trace* t, int pool, int mru)
+{
+  char* in = xalloc(NULL, t->distinct, 1);
+  memset(in, 0, t->distinct);
+  List l;
+  list_init(&l);
+  long long hits = 0;
+  for (size_t i = 0; i < t->n; i++) {
+    int id = t->acc[i].id;
+    if (t->acc[i].counts == EVICT) {
+      if (in[id]) list_remove(&l, id);
+      in[id] = 0;
+      continue;
+    }
+    if (in[id]) {
+      hits += t->acc[i].counts;
+      list_remove(&l, id);
+    } else {
+      if (l.size == pool) {
+        int victim = mru ? l.head : l.tail;
+        list_remove(&l, victim);
+        in[victim] = 0;
+      }
+      in[id] = 1;
+    }
+    list_push_front(&l, id);
+  }
+  free(in);
+  return hits;
+}
+
+static long long sim_clock(const Trace* t, int pool)
+{
+  int* frame_of = xalloc(NULL, t->distinct, sizeof(int));
+  for (int i = 0; i < t->distinct; i++) frame_of[i] = NIL;
+  int* frames = xalloc(NULL, pool, sizeof(int));
+  char* ref = xalloc(NULL, pool, 1);
+  memset(ref, 0, pool);
+  int* free_frames = xalloc(NULL, pool, sizeof(int));
+  int used = 0, hand = 0, nfree = 0;
+  long long hits = 0;
+  for (size_t i = 0; i < t->n; i++) {
+    int id = t->acc[i].id;
+    if (t->acc[i].counts == EVICT) {
+      if (frame_of[id] != NIL) {
+        ref[frame_of[id]] = 0;
+        free_frames[nfree++] = frame_of[id];
+        frame_of[id] = NIL;
+      }
+      continue;
+    }
+    if (frame_of[id] != NIL) {
+      hits += t->acc[i].counts;
+      ref[frame_of[id]] = 1;
+      continue;
+    }
+    int f;
+    if (nfree > 0) {
+      f = free_frames[--nfree];
+    } else if (used < pool) {
+      f = used++;
+    } else {
+      while (ref[hand]) {
+        ref[hand] = 0;
+        hand = (hand + 1) % pool;
+      }
+      f = hand;
+      frame_of[frames[f]] = NIL;
+      hand = (hand + 1) % pool;
+    }
+    frames[f] = id;
+    frame_of[id] = f;
+    ref[f] = 1;
+  }
+  free(frame_of);
+  free(frames);
+  free(ref);
+  free(free_frames);
+  return hits;
+}
+
+enum { Q_NONE, Q_A1IN, Q_A1OUT, Q_AM };
+
+static long long sim_2q(const Trace* t, int pool)
+{
+  char* where = xalloc(NULL, t->distinct, 1);
+  memset(where, Q_NONE, t->distinct);
+  List a1in, a1out, am;
+  list_init(&a1in);
+  list_init(&a1out);
+  list_init(&am);
+  int kin = pool / 4 > 0 ? pool / 4 : 1;
+  int kout = pool / 2 > 0 ? pool / 2 : 1;
+  long long hits = 0;
+  for (size_t i = 0; i < t->n; i++) {
+    int id = t->acc[i].id;
+    if (t->acc[i].counts == EVICT) {
+      // kai to ghost sto A1out, afou to id den tha ksanazhththei
+      if (where[id] == Q_A1IN) list_remove(&a1in, id);
+      else if (where[id] == Q_A1OUT) list_remove(&a1out, id);
+      else if (where[id] == Q_AM) list_remove(&am, id);
+      where[id] = Q_NONE;
+      continue;
+    }
+    if (where[id] == Q_AM) {
+      hits += t->acc[i].counts;
+      list_remove(&am, id);
+      list_push_front(&am, id);
+      continue;
+    }
+    if (where[id] == Q_A1IN) {
+      hits += t->acc[i].counts;
+      continue;
+    }
+    // miss: eleutherwnoume ena frame an to buffer einai gemato
+    if (a1in.size + am.size >= pool) {
+      if (a1in.size > kin || am.size == 0) {
+        int victim = a1in.tail;
+        list_remove(&a1in, victim);
+        list_push_front(&a1out, victim);
+        where[victim] = Q_A1OUT;
+        if (a1out.size > kout) {
+          int old = a1out.tail;
+          list_remove(&a1out, old);
+          where[old] = Q_NONE;
+        }
+      } else {
+        int victim = am.tail;
+        list_remove(&am, victim);
+        where[victim] = Q_NONE;
+      }
+    }
+    if (where[id] == Q_A1OUT) {
+      list_remove(&a1out, id);
+      list_push_front(&am, id);
+      where[id] = Q_AM;
+    } else {
+      list_push_front(&a1in, id);
+      where[id] = Q_A1IN;
+    }
+  }
+  free(where);
+  return hits;
+}
+
+// Belady: vgazoume to block pou tha ksanazhththei pio argotera (max-heap me lazy diagrafh)
+typedef struct HeapItem {
+  size_t next_use;
+  int id;
+} HeapItem;
+
+static void heap_push(HeapItem* h, size_t* n, HeapItem item)
+{
+  size_t i = (*n)++;
+  while (i > 0 && h[(i - 1) / 2].next_use < item.next_use) {
+    h[i] = h[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  h[i] = item;
+}
+
+static HeapItem heap_pop(HeapItem* h, size_t* n)
+{
+  HeapItem top = h[0];
+  HeapItem last = h[--(*n)];
+  size_t i = 0;
+  for (;;) {
+    size_t c = 2 * i + 1;
+    if (c >= *n) break;
+    if (c + 1 < *n && h[c + 1].next_use > h[c].next_use) c++;
+    if (h[c].next_use <= last.next_use) break;
+    h[i] = h[c];
+    i = c;
+  }
+  h[i] = last;
+  return top;
+}
+
+static long long sim_opt(const Trace* t, int pool)
+{
+  size_t* next_use = xalloc(NULL, t->n, sizeof(size_t));
+  size_t* seen = xalloc(NULL, t->distinct, sizeof(size_t));
+  for (int i = 0; i < t->distinct; i++) seen[i] = t->n;
+  for (size_t i = t->n; i-- > 0;) {
+    if (t->acc[i].counts == EVICT) continue;
+    next_use[i] = seen[t->acc[i].id];
+    seen[t->acc[i].id] = i;
+  }
+  // seen[id]: h epomenh xrhsh tou id an einai sto buffer, alliws NEVER
+  for (int i = 0; i < t->distinct; i++) seen[i] = NEVER;
+  HeapItem* heap = xalloc(NULL, t->n + 1, sizeof(HeapItem));
+  size_t heap_n = 0;
+  int resident = 0;
+  long long hits = 0;
+  for (size_t i = 0; i < t->n; i++) {
+    int id = t->acc[i].id;
+    if (t->acc[i].counts == EVICT) {
+      // h eggrafh sto heap menei kai agnoeitai sto pop (lazy diagrafh)
+      if (seen[id] != NEVER) {
+        seen[id] = NEVER;
+        resident--;
+      }
+      continue;
+    }
+    if (seen[id] != NEVER) {
+      hits += t->acc[i].counts;
+    } else {
+      if (resident == pool) {
+        for (;;) {
+          HeapItem top = heap_pop(heap, &heap_n);
+          if (seen[top.id] == top.next_use) {
+            seen[top.id] = NEVER;
+            break;
+          }
+        }
+        resident--;
+      }
+      resident++;
+    }
+    seen[id] = next_use[i];
+    HeapItem item = {next_use[i], id};
+    heap_push(heap, &heap_n, item);
+  }
+  free(next_use);
+  free(seen);
+  free(heap);
+  return hits;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-p pool,pool,...] <trace-file>\n", prog);
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  const char* pools_arg = DEFAULT_POOLS;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:")) != -1) {
+    switch (opt) {
+      case 'p': pools_arg = optarg; break;
+      default: usage(argv[0]);
+    }
+  }
+  if (argc - optind != 1) usage(argv[0]);
+
+  int pools[MAX_POOLS];
+  int npools = 0;
+  for (const char* p = pools_arg; *p && npools < MAX_POOLS;) {
+    char* e;
+    pools[npools] = (int)strtol(p, &e, 10);
+    if (e == p || pools[npools] <= 0) usage(argv[0]);
+    npools++;
+    p = *e == ',' ? e + 1 : e;
+  }
+
+  Trace t = load_trace(argv[optind]);
+  long long counted = t.reads + t.writes;
+  printf("%lld block requests: %lld reads, %lld writes, %lld allocations; %lld scan, %lld point; %lld file closes\n",
+         t.reads + t.writes + t.allocs, t.reads, t.writes, t.allocs, t.scans, t.points, t.closes);
+  printf("%d distinct blocks, BF buffer is %d blocks\n\n", t.distinct, BF_BUFFER_SIZE);
+  if (counted == 0) return 0;
+
+  prev_of = xalloc(NULL, t.distinct, sizeof(int));
+  next_of = xalloc(NULL, t.distinct, sizeof(int));
+
+  printf("hit rate %%\n%8s %8s %8s %8s %8s %8s\n", "pool", "LRU", "MRU", "CLOCK", "2Q", "OPT");
+  for (int p = 0; p < npools; p++) {
+    int pool = pools[p];
+    printf("%8d %8.2f %8.2f %8.2f %8.2f %8.2f\n", pool,
+           100.0 * sim_recency(&t, pool, 0) / counted,
+           100.0 * sim_recency(&t, pool, 1) / counted,
+           100.0 * sim_clock(&t, pool) / counted,
+           100.0 * sim_2q(&t, pool) / counted,
+           100.0 * sim_opt(&t, pool) / counted);
+  }
+
+  free(prev_of);
+  free(next_of);
+  free(t.acc);
+  return 0;
+}
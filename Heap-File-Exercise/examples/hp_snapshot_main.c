@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "../include/bf.h"
+#include "../include/hp_file_structs.h"
+#include "../include/hp_file_funcs.h"
+
+/*
+ * Paradeigma snapshot iterator: ena nhma eisagei eggrafes sto heap file kai
+ * ena allo to sarwnei parallhla apo ena snapshot. To BF den einai thread-safe,
+ * opote kathe klhsh HP ginetai me to hp_lock, alla h sarwsh den krataei to
+ * lock (oute pinned block) anamesa stis eggrafes. O writer stamataei mono mexri
+ * na dhmiourghthei to snapshot sto SNAPSHOT_AT, wste to teleutaio block na einai
+ * panta miso gemato, kai meta synexizei xwris na perimenei th sarwsh.
+ */
+
+#define RECORDS_NUM 20000
+#define SNAPSHOT_AT 10003 // oxi pollaplasio tou HP_RECORDS_PER_BLOCK: miso gemato teleutaio block
+#define FILE_NAME "snapshot.db"
+
+static pthread_mutex_t hp_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t snapshot_ready = PTHREAD_COND_INITIALIZER;  // o writer eftase sto SNAPSHOT_AT
+static pthread_cond_t snapshot_taken = PTHREAD_COND_INITIALIZER;  // o reader eftiakse to snapshot
+static int snapshot_created = 0;
+static int file_handle;
+static HeapFileHeader* header_info;
+static int inserted = 0;
+
+static void* writer(void* arg)
+{
+  (void)arg;
+  srand(12569874);
+  for (int id = 0; id < RECORDS_NUM; ++id) {
+    Record rec = randomRecord();
+    rec.id = id;
+    pthread_mutex_lock(&hp_lock);
+    HeapFile_InsertRecord(file_handle, header_info, rec);
+    inserted = id + 1;
+    if (inserted == SNAPSHOT_AT) {
+      pthread_cond_signal(&snapshot_ready);
+      while (!snapshot_created) pthread_cond_wait(&snapshot_taken, &hp_lock);
+    }
+    pthread_mutex_unlock(&hp_lock);
+  }
+  return NULL;
+}
+
+static void* reader(void* arg)
+{
+  (void)arg;
+  HeapFileSnapshotIterator it;
+  pthread_mutex_lock(&hp_lock);
+  while (inserted < SNAPSHOT_AT) pthread_cond_wait(&snapshot_ready, &hp_lock);
+  int at = inserted;
+  HeapFile_CreateSnapshotIterator(file_handle, header_info, -1, &it);
+  int tail_count = it.tail_count;
+  snapshot_created = 1;
+  pthread_cond_signal(&snapshot_taken);
+  pthread_mutex_unlock(&hp_lock);
+
+  Record rec;
+  int count = 0, in_order = 1;
+  for (;;) {
+    pthread_mutex_lock(&hp_lock);
+    int found = HeapFile_GetNextSnapshotRecord(&it, &rec);
+    pthread_mutex_unlock(&hp_lock);
+    if (!found) break;
+    if (rec.id != count) in_order = 0;
+    count++;
+  }
+  printf("Snapshot taken at %d records (%d of %d in the copied tail block): scanned %d records%s\n",
+         at, tail_count, HP_RECORDS_PER_BLOCK, count,
+         count == at && in_order ? " (consistent prefix)" : " (INCONSISTENT)");
+  return NULL;
+}
+
+int main()
+{
+  BF_Init(LRU);
+  HeapFile_Create(FILE_NAME);
+  HeapFile_Open(FILE_NAME, &file_handle, &header_info);
+
+  pthread_t w, r;
+  pthread_create(&r, NULL, reader, NULL);
+  pthread_create(&w, NULL, writer, NULL);
+  pthread_join(w, NULL);
+  pthread_join(r, NULL);
+
+  HeapFileSnapshotIterator it;
+  HeapFile_CreateSnapshotIterator(file_handle, header_info, -1, &it);
+  Record rec;
+  int count = 0;
+  while (HeapFile_GetNextSnapshotRecord(&it, &rec)) count++;
+  printf("After the writer finished: %d records\n", count);
+
+  HeapFile_Close(file_handle, header_info);
+  BF_Close();
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+
+#include "../include/bf.h"
+#include "../include/hp_file.hpp"
+#include "../include/record.h"
+
+/*
+ * Paradeigma xrhshs tou C++ HeapFile<T>: ena arxeio me Record (idio format me
+ * to hp_main) kai ena me diko mas typo eggrafhs.
+ */
+
+#define RECORDS_NUM 10000
+#define RECORD_FILE_NAME "typed_records.db"
+#define SAMPLE_FILE_NAME "typed_samples.db"
+
+struct Sample {
+  int sensor;
+  int timestamp;
+  double value;
+};
+
+static void records_demo()
+{
+  hp::HeapFile<Record>::create(RECORD_FILE_NAME);
+  hp::HeapFile<Record> file(RECORD_FILE_NAME);
+
+  srand(12569874);
+  for (int i = 0; i < RECORDS_NUM; ++i) file.insert(randomRecord());
+  file.flush();
+
+  std::printf("Record: %d records per block, trailer at byte %zu\n",
+              hp::HeapFile<Record>::records_per_block, hp::HeapFile<Record>::trailer_offset);
+
+  int id = 168;
+  std::printf("Print records with id=%d\n", id);
+  for (const Record& rec : file.scan([id](const Record& r) { return r.id == id; }))
+    printRecord(rec);
+
+  auto all = file.records();
+  long athina = std::count_if(all.begin(), all.end(),
+                              [](const Record& r) { return r.city[0] == 'A'; });
+  std::printf("Records in Athina: %ld\n", athina);
+}
+
+static void samples_demo()
+{
+  hp::HeapFile<Sample>::create(SAMPLE_FILE_NAME);
+  hp::HeapFile<Sample> file(SAMPLE_FILE_NAME);
+  for (int t = 0; t < RECORDS_NUM; ++t) file.insert(Sample{t % 16, t, (t % 100) / 10.0});
+
+  std::printf("Sample: %d records per block\n", hp::HeapFile<Sample>::records_per_block);
+
+  double sum = 0;
+  int n = 0;
+  file.for_each([](const Sample& s) { return s.sensor == 3; },
+                [&](const Sample& s) { sum += s.value; n++; });
+  std::printf("Sensor 3: %d samples, mean value %.3f\n", n, n ? sum / n : 0.0);
+
+  auto total = file.records();
+  double total_value = std::accumulate(total.begin(), total.end(), 0.0,
+                                       [](double acc, const Sample& s) { return acc + s.value; });
+  std::printf("Total value: %.1f\n", total_value);
+}
+
+int main()
+{
+  try {
+    hp::check(BF_Init(LRU));
+    records_demo();
+    samples_demo();
+    hp::check(BF_Close());
+  } catch (const hp::BFError& e) {
+    BF_PrintError(e.code());
+    return e.code();
+  }
+}
@@ -0,0 +1,429 @@
+#ifndef HP_FILE_HPP
+#define HP_FILE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bf.h"
+#include "hp_file_structs.h"
+
+/**
+ * @file hp_file.hpp
+ * @brief Header-only C++ heap file layer over the BF library
+ *
+ * HeapFile<T> stores any trivially copyable T using the same on-disk layout
+ * as the C HP layer (header in block 0, records packed from the start of each
+ * data block, HeapFileBlockMetadata in the block trailer), so a
+ * HeapFile<Record> can be read and written by both APIs.
+ *
+ * Block geometry is computed at compile time, blocks are pinned through RAII
+ * guards, and scans hand out references into the pinned block instead of
+ * malloc'd copies. BF errors are reported by throwing hp::BFError.
+ */
+
+namespace hp {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Errors                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exception carrying the BF_ErrorCode of a failed BF call
+ */
+class BFError : public std::runtime_error {
+public:
+  explicit BFError(BF_ErrorCode code, const char* what = "BF call failed")
+    : std::runtime_error(what), code_(code) {}
+
+  BF_ErrorCode code() const noexcept { return code_; }
+
+private:
+  BF_ErrorCode code_;
+};
+
+inline void check(BF_ErrorCode code)
+{
+  if (code != BF_OK) throw BFError(code);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Block pins                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Owns a BF_Block and keeps at most one block pinned through it
+ *
+ * The pin is released when another block is fetched, on release(), or on
+ * destruction. Move-only.
+ */
+class PinnedBlock {
+public:
+  PinnedBlock() { BF_Block_Init(&block_); }
+  ~PinnedBlock() { reset(); }
+
+  PinnedBlock(PinnedBlock&& other) noexcept
+    : block_(std::exchange(other.block_, nullptr)),
+      pinned_(std::exchange(other.pinned_, false)) {}
+  PinnedBlock& operator=(PinnedBlock&& other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      block_ = std::exchange(other.block_, nullptr);
+      pinned_ = std::exchange(other.pinned_, false);
+    }
+    return *this;
+  }
+  PinnedBlock(const PinnedBlock&) = delete;
+  PinnedBlock& operator=(const PinnedBlock&) = delete;
+
+  /** @brief Pins block @p block_num of the file, unpinning the previous one */
+  void get(int file_handle, int block_num)
+  {
+    release();
+    check(BF_GetBlock(file_handle, block_num, block_));
+    pinned_ = true;
+  }
+
+  /** @brief Allocates and pins a new block at the end of the file */
+  void allocate(int file_handle)
+  {
+    release();
+    check(BF_AllocateBlock(file_handle, block_));
+    pinned_ = true;
+  }
+
+  void release() noexcept
+  {
+    if (!pinned_) return;
+    BF_UnpinBlock(block_);
+    pinned_ = false;
+  }
+
+  void set_dirty() { BF_Block_SetDirty(block_); }
+  bool pinned() const noexcept { return pinned_; }
+  char* data() const { return BF_Block_GetData(block_); }
+
+private:
+  void reset() noexcept
+  {
+    if (block_ == nullptr) return;
+    release();
+    BF_Block_Destroy(&block_);
+    block_ = nullptr;
+  }
+
+  BF_Block* block_ = nullptr;
+  bool pinned_ = false;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  HeapFile                                  */
+/* -------------------------------------------------------------------------- */
+
+/** @brief Predicate accepting every record, used by HeapFile::records() */
+struct AllRecords {
+  template <typename T>
+  constexpr bool operator()(const T&) const noexcept { return true; }
+};
+
+/**
+ * @brief Typed heap file of trivially copyable records
+ *
+ * Move-only handle to one open instance of a heap file. Unlike the C API the
+ * header block is rewritten only by flush() and close(), and the insertion
+ * block stays pinned between insert() calls.
+ */
+template <typename T>
+class HeapFile {
+  static_assert(std::is_trivially_copyable<T>::value, "HeapFile<T> requires a trivially copyable T");
+  static_assert(alignof(T) <= alignof(std::max_align_t), "HeapFile<T> cannot over-align records inside a block");
+
+public:
+  /** @brief Byte offset of the HeapFileBlockMetadata trailer in every data block */
+  static constexpr std::size_t trailer_offset = BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata);
+  /** @brief Number of T that fit in a data block */
+  static constexpr int records_per_block = static_cast<int>(trailer_offset / sizeof(T));
+
+  static_assert(records_per_block > 0, "T does not fit in a single block");
+
+  template <typename Pred>
+  class Scan;
+
+  /** @brief Creates an empty heap file; the file must not exist */
+  static void create(const char* file_name)
+  {
+    check(BF_CreateFile(file_name));
+    int file_handle;
+    check(BF_OpenFile(file_name, &file_handle));
+    try {
+      PinnedBlock header_block;
+      header_block.allocate(file_handle);
+      HeapFileHeader header{};
+      header.blocks_num = 1;
+      header.currentblockid = -1;
+      std::strcpy(header.file_type, "heap");
+      std::memcpy(header_block.data(), &header, sizeof(header));
+      header_block.set_dirty();
+    } catch (...) {
+      BF_CloseFile(file_handle);
+      throw;
+    }
+    check(BF_CloseFile(file_handle));
+  }
+
+  /** @brief Opens an existing heap file and loads its header */
+  explicit HeapFile(const char* file_name)
+  {
+    check(BF_OpenFile(file_name, &file_handle_));
+    // o destructor den trexei an petaksoume edw, opote kleinoume to arxeio emeis
+    try {
+      PinnedBlock header_block;
+      header_block.get(file_handle_, 0);
+      std::memcpy(&header_, header_block.data(), sizeof(header_));
+      if (std::strncmp(header_.file_type, "heap", sizeof(header_.file_type)) != 0)
+        throw BFError(BF_ERROR, "not a heap file");
+    } catch (...) {
+      BF_CloseFile(file_handle_);
+      throw;
+    }
+    open_ = true;
+  }
+
+  ~HeapFile() { close_quietly(); }
+
+  HeapFile(HeapFile&& other) noexcept
+    : file_handle_(other.file_handle_),
+      header_(other.header_),
+      tail_(std::move(other.tail_)),
+      header_dirty_(other.header_dirty_),
+      open_(std::exchange(other.open_, false)) {}
+  HeapFile& operator=(HeapFile&& other) noexcept
+  {
+    if (this != &other) {
+      close_quietly();
+      file_handle_ = other.file_handle_;
+      header_ = other.header_;
+      tail_ = std::move(other.tail_);
+      header_dirty_ = other.header_dirty_;
+      open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+  }
+  HeapFile(const HeapFile&) = delete;
+  HeapFile& operator=(const HeapFile&) = delete;
+
+  /** @brief Appends a record, allocating a new block when the tail is full */
+  void insert(const T& record)
+  {
+    HeapFileBlockMetadata* mdata = nullptr;
+    if (header_.currentblockid != -1) {
+      if (!tail_.pinned()) tail_.get(file_handle_, header_.currentblockid);
+      mdata = trailer(tail_.data());
+    }
+    if (mdata == nullptr || mdata->record_count == records_per_block) {
+      tail_.allocate(file_handle_);
+      mdata = trailer(tail_.data());
+      mdata->record_count = 0;
+      mdata->next_block_id = -1;
+      header_.currentblockid = header_.blocks_num;
+      header_.blocks_num += 1;
+      header_dirty_ = true;
+    }
+    std::memcpy(tail_.data() + mdata->record_count * sizeof(T), &record, sizeof(T));
+    mdata->record_count += 1;
+    tail_.set_dirty();
+  }
+
+  /** @brief Unpins the insertion block and writes the header if it changed */
+  void flush()
+  {
+    tail_.release();
+    if (!header_dirty_) return;
+    PinnedBlock header_block;
+    header_block.get(file_handle_, 0);
+    std::memcpy(header_block.data(), &header_, sizeof(header_));
+    header_block.set_dirty();
+    header_dirty_ = false;
+  }
+
+  /** @brief Flushes and closes the file; the handle is unusable afterwards */
+  void close()
+  {
+    if (!open_) return;
+    flush();
+    open_ = false;
+    check(BF_CloseFile(file_handle_));
+  }
+
+  /**
+   * @brief Range over the records for which @p pred returns true
+   *
+   * Unpins the insertion block first: the BF layer loses updates to a block
+   * that is pinned twice, so insert() must not be called while a scan is on
+   * the last block.
+   */
+  template <typename Pred>
+  Scan<Pred> scan(Pred pred)
+  {
+    tail_.release();
+    return Scan<Pred>(file_handle_, header_.blocks_num, std::move(pred));
+  }
+
+  /** @brief Range over every record of the file */
+  Scan<AllRecords> records() { return scan(AllRecords{}); }
+
+  /** @brief Calls @p fn on every record for which @p pred returns true */
+  template <typename Pred, typename Fn>
+  void for_each(Pred pred, Fn fn)
+  {
+    tail_.release();
+    PinnedBlock block;
+    for (int b = 1; b < header_.blocks_num; b++) {
+      block.get(file_handle_, b);
+      const char* data = block.data();
+      const int count = trailer(data)->record_count;
+      const T* recs = reinterpret_cast<const T*>(data);
+      for (int i = 0; i < count; i++)
+        if (pred(recs[i])) fn(recs[i]);
+    }
+  }
+
+  int file_handle() const noexcept { return file_handle_; }
+  const HeapFileHeader& header() const noexcept { return header_; }
+
+  static HeapFileBlockMetadata* trailer(char* data)
+  {
+    return reinterpret_cast<HeapFileBlockMetadata*>(data + trailer_offset);
+  }
+  static const HeapFileBlockMetadata* trailer(const char* data)
+  {
+    return reinterpret_cast<const HeapFileBlockMetadata*>(data + trailer_offset);
+  }
+
+private:
+  void close_quietly() noexcept
+  {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  int file_handle_ = -1;
+  HeapFileHeader header_{};
+  PinnedBlock tail_;
+  bool header_dirty_ = false;
+  bool open_ = false;
+};
+
+/**
+ * @brief Single-pass range over the matching records of a HeapFile
+ *
+ * Keeps the block of the current record pinned; references handed out by the
+ * iterator stay valid until it is advanced. The block count is taken when the
+ * scan is created.
+ */
+template <typename T>
+template <typename Pred>
+class HeapFile<T>::Scan {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    /** @brief Result of it++: keeps a copy of the record it pointed to */
+    class postfix_proxy {
+    public:
+      explicit postfix_proxy(const T& value) : value_(value) {}
+      const T& operator*() const { return value_; }
+
+    private:
+      T value_;
+    };
+
+    iterator() = default;
+    explicit iterator(Scan* scan) : scan_(scan) {}
+
+    reference operator*() const { return scan_->current(); }
+    pointer operator->() const { return &scan_->current(); }
+    iterator& operator++()
+    {
+      scan_->advance();
+      return *this;
+    }
+    postfix_proxy operator++(int)
+    {
+      postfix_proxy old(scan_->current());
+      scan_->advance();
+      return old;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) { return a.done() == b.done(); }
+    friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+
+  private:
+    bool done() const { return scan_ == nullptr || scan_->done_; }
+
+    Scan* scan_ = nullptr;
+  };
+
+  Scan(int file_handle, int blocks_num, Pred pred)
+    : file_handle_(file_handle), blocks_num_(blocks_num), pred_(std::move(pred)) {}
+
+  Scan(Scan&&) = default;
+  Scan(const Scan&) = delete;
+  Scan& operator=(const Scan&) = delete;
+
+  iterator begin()
+  {
+    if (!started_) {
+      started_ = true;
+      advance();
+    }
+    return iterator(this);
+  }
+  iterator end() { return iterator(); }
+
+private:
+  const T& current() const { return reinterpret_cast<const T*>(data_)[index_]; }
+
+  void advance()
+  {
+    for (;;) {
+      while (++index_ < count_)
+        if (pred_(current())) return;
+      if (++block_ >= blocks_num_) {
+        block_pin_.release();
+        done_ = true;
+        return;
+      }
+      block_pin_.get(file_handle_, block_);
+      data_ = block_pin_.data();
+      count_ = trailer(data_)->record_count;
+      index_ = -1;
+    }
+  }
+
+  int file_handle_;
+  int blocks_num_;
+  Pred pred_;
+  PinnedBlock block_pin_;
+  const char* data_ = nullptr;
+  int block_ = 0;
+  int index_ = -1;
+  int count_ = 0;
+  bool started_ = false;
+  bool done_ = false;
+};
+
+}  // namespace hp
+
+#endif /* HP_FILE_HPP */
@@ -1,8 +1,13 @@
 #ifndef HP_FILE_FUNCS_H
 #define HP_FILE_FUNCS_H
 
+#include <stdio.h>
 #include "hp_file_structs.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @file hp_file_funcs.h
  * @brief Heap File API functions for creation, access, and record management
@@ -51,6 +56,57 @@ int HeapFile_Close(int file_handle, HeapFileHeader* header_info);
  */
 int HeapFile_InsertRecord(int file_handle, HeapFileHeader* header_info, Record record);
 
+/**
+ * @brief Creates an iterator over a snapshot of the heap file
+ *
+ * The iterator returns only the records that exist when it is created, even
+ * if records are inserted while it is in use. It never keeps a block pinned
+ * between calls and never marks blocks dirty, so inserts are not blocked.
+ * The BF layer is not thread-safe: a reader and a writer in different
+ * threads must still serialize their individual HP calls.
+ *
+ * @param file_handle Handle of the heap file to iterate over
+ * @param header_info Pointer to heap file metadata
+ * @param search_id Record ID to filter during iteration, or -1 for all records
+ * @param iterator Output parameter for the initialized iterator
+ * @return 1 on success, 0 on failure
+ */
+int HeapFile_CreateSnapshotIterator(int file_handle, HeapFileHeader* header_info, int search_id, HeapFileSnapshotIterator* iterator);
+
+/**
+ * @brief Retrieves the next matching record of a snapshot
+ *
+ * @param iterator Iterator created by HeapFile_CreateSnapshotIterator
+ * @param record Output parameter that receives a copy of the found record
+ * @return 1 if a record was found, 0 if no more records match
+ */
+int HeapFile_GetNextSnapshotRecord(HeapFileSnapshotIterator* iterator, Record* record);
+
+/**
+ * @brief Appends a batch of records to the heap file
+ *
+ * Fills the current insertion block and then allocates new blocks at the end
+ * of the file, keeping each block pinned only while it is being filled.
+ * The header block is NOT rewritten; call HeapFile_FlushHeader() after the
+ * batches, including after a batch that failed part of the way.
+ *
+ * @param file_handle Handle of the heap file
+ * @param header_info Pointer to heap file metadata (updated in memory)
+ * @param records Array of records to insert
+ * @param count Number of records in the array
+ * @return 1 on success, 0 on failure
+ */
+int HeapFile_InsertRecords(int file_handle, HeapFileHeader* header_info, const Record* records, int count);
+
+/**
+ * @brief Writes the in-memory header back to block 0 of the heap file
+ *
+ * @param file_handle Handle of the heap file
+ * @param header_info Pointer to heap file metadata
+ * @return 1 on success, 0 on failure
+ */
+int HeapFile_FlushHeader(int file_handle, HeapFileHeader* header_info);
+
 /**
  * @brief Retrieves the next matching record using an iterator
  *
@@ -70,4 +126,92 @@ int HeapFile_GetNextRecord(HeapFileIterator* heap_iterator, Record** record);
  */
 HeapFileIterator HeapFile_CreateIterator(int file_handle, HeapFileHeader* header_info, int search_id);
 
+/**
+ * @brief Writes every matching record of the heap file to a file descriptor
+ *
+ * Walks the data blocks in order and formats records into one large output
+ * buffer that is flushed with write(), without any per-record allocation.
+ * CSV fields containing ',', '"' or a line break are quoted as in RFC 4180.
+ *
+ * @param file_handle Handle of the heap file
+ * @param header_info Pointer to heap file metadata
+ * @param fd Destination file descriptor
+ * @param format HP_EXPORT_CSV or HP_EXPORT_BINARY
+ * @param search_id Record ID to export, or -1 for all records
+ * @return Number of records written, or -1 on failure
+ */
+long long HeapFile_Export(int file_handle, HeapFileHeader* header_info, int fd, HeapFileExportFormat format, int search_id);
+
+/**
+ * @brief Copies a heap file block by block into a new heap file
+ *
+ * Data blocks are copied whole; empty data blocks are dropped, so the copy
+ * is also compacted. The destination file must not exist.
+ *
+ * @param file_handle Handle of the source heap file
+ * @param header_info Pointer to the source heap file metadata
+ * @param dst_file_name Name of the heap file to create
+ * @return Number of data blocks in the new file, or -1 on failure
+ */
+int HeapFile_Copy(int file_handle, HeapFileHeader* header_info, const char* dst_file_name);
+
+/* -------------------------------------------------------------------------- */
+/*                                  Metrics                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Copies the HP layer counters into @p metrics
+ *
+ * @param metrics Output parameter for the counters (zeroed if metrics are disabled)
+ * @return 1 if the library was built with -DHP_METRICS, 0 otherwise
+ */
+int HeapFile_GetMetrics(HeapFileMetrics* metrics);
+
+/**
+ * @brief Resets all HP layer counters to zero
+ */
+void HeapFile_ResetMetrics();
+
+/**
+ * @brief Prints the HP layer counters, one per line or as a single JSON object
+ *
+ * @param out Destination stream
+ * @param json 1 for a one-line JSON object, 0 for plain text
+ */
+void HeapFile_DumpMetrics(FILE* out, int json);
+
+/**
+ * @brief Dumps the counters to @p out after every @p every_ops HP operations
+ *
+ * @param out Destination stream
+ * @param json 1 for JSON lines, 0 for plain text
+ * @param every_ops Dump period in HP operations; 0 disables periodic dumps
+ * @return 1 if the library was built with -DHP_METRICS, 0 otherwise
+ */
+int HeapFile_SetMetricsDump(FILE* out, int json, unsigned long long every_ops);
+
+/* -------------------------------------------------------------------------- */
+/*                                  Tracing                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Starts logging every block request of the HP layer to a trace file
+ *
+ * The trace can be replayed against other buffer policies with hp_simulate.
+ *
+ * @param path Trace file to create (overwritten if it exists)
+ * @return 1 on success, 0 if a trace is already active or the file cannot be written
+ */
+int HeapFile_TraceStart(const char* path);
+
+/**
+ * @brief Flushes and closes the active trace file
+ *
+ * @return 1 on success, 0 if no trace was active or any write to the trace file failed
+ */
+int HeapFile_TraceStop();
+
+#ifdef __cplusplus
+}
+#endif
 #endif /* HP_FILE_FUNCS_H */
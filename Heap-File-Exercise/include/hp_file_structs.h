@@ -1,8 +1,13 @@
 #ifndef HP_FILE_STRUCTS_H
 #define HP_FILE_STRUCTS_H
 
+#include "bf.h"
 #include "record.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @file hp_file_structs.h
  * @brief Data structures for heap file management
@@ -32,6 +37,11 @@ typedef struct HeapFileBlockMetadata {
     int next_block_id;
 } HeapFileBlockMetadata;
 
+/**
+ * @brief Maximum number of records in a data block (the metadata sits at the end of the block)
+ */
+#define HP_RECORDS_PER_BLOCK ((int)((BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata)) / sizeof(Record)))
+
 
 /**
  * @brief Iterator for scanning through records in a heap file
@@ -46,4 +56,108 @@ typedef struct HeapFileIterator{
 
 } HeapFileIterator;
 
+
+/**
+ * @brief Iterator over a fixed snapshot of a heap file
+ *
+ * Captures the block count and the record count of the last block when it
+ * is created. Full blocks never change in a heap file, and the partially
+ * filled last block is copied into the iterator, so the scan sees exactly
+ * the records that existed at creation time while inserts continue.
+ */
+typedef struct HeapFileSnapshotIterator{
+    int file_handle; // Handle of the heap file to iterate over
+    int search_id; // Record ID to filter during iteration, -1 for all
+    int blocks_num; // blocks_num tou header th stigmh tou snapshot
+    int tail_block; // to miso gemato teleutaio block (h -1 an htan gemato)
+    int tail_count; // poses eggrafes eixe to tail_block sto snapshot
+    int current_block; // to eksetazomeno block
+    int current_record; // h epomenh eggrafh tou block (apo 0)
+    Record tail_records[HP_RECORDS_PER_BLOCK]; // antigrafo tou tail_block
+} HeapFileSnapshotIterator;
+
+/**
+ * @brief Output format for HeapFile_Export
+ */
+typedef enum HeapFileExportFormat {
+    HP_EXPORT_CSV,    /**< One "id,name,surname,city" line per record */
+    HP_EXPORT_BINARY  /**< Raw Record structs, as read by hp_import -b */
+} HeapFileExportFormat;
+
+/**
+ * @brief Counters collected by the HP layer when built with -DHP_METRICS
+ *
+ * The *_cycles fields and the hit/miss split are only filled in when
+ * -DHP_METRICS_TIMING is also given. A BF_GetBlock slower than
+ * HP_METRICS_MISS_CYCLES is counted as a buffer miss.
+ */
+typedef struct HeapFileMetrics {
+    unsigned long long op_create;       /**< HeapFile_Create calls */
+    unsigned long long op_open;         /**< HeapFile_Open calls */
+    unsigned long long op_close;        /**< HeapFile_Close calls */
+    unsigned long long op_insert;       /**< HeapFile_InsertRecord calls */
+    unsigned long long op_insert_batch; /**< HeapFile_InsertRecords calls */
+    unsigned long long op_next_record;  /**< HeapFile_GetNextRecord calls */
+    unsigned long long op_export;       /**< HeapFile_Export calls */
+    unsigned long long op_copy;         /**< HeapFile_Copy calls */
+    unsigned long long op_snapshot;     /**< HeapFile_CreateSnapshotIterator calls */
+    unsigned long long op_next_snapshot_record; /**< HeapFile_GetNextSnapshotRecord calls */
+
+    unsigned long long get_block_calls;      /**< BF_GetBlock calls */
+    unsigned long long allocate_block_calls; /**< BF_AllocateBlock calls */
+    unsigned long long unpin_calls;          /**< BF_UnpinBlock calls */
+    unsigned long long set_dirty_calls;      /**< BF_Block_SetDirty calls */
+    unsigned long long pages_pinned;         /**< Successful GetBlock/AllocateBlock calls */
+    unsigned long long dirty_on_read;        /**< Blocks marked dirty by read-only scans */
+    unsigned long long header_writes;        /**< Rewrites of the header block */
+
+    unsigned long long buffer_hits;           /**< GetBlock calls inferred as buffer hits */
+    unsigned long long buffer_misses;         /**< GetBlock calls inferred as buffer misses */
+    unsigned long long get_block_cycles;      /**< rdtsc cycles spent in BF_GetBlock */
+    unsigned long long allocate_block_cycles; /**< rdtsc cycles spent in BF_AllocateBlock */
+    unsigned long long unpin_cycles;          /**< rdtsc cycles spent in BF_UnpinBlock */
+} HeapFileMetrics;
+
+/**
+ * @brief Magic bytes and version at the start of a block-access trace file
+ */
+#define HP_TRACE_MAGIC "HPTR"
+#define HP_TRACE_VERSION 1
+
+/**
+ * @brief Flags of a HeapFileTraceEntry
+ *
+ * An entry with neither HP_TRACE_WRITE nor HP_TRACE_SCAN is a read of a
+ * single block (point access).
+ */
+typedef enum HeapFileTraceFlags {
+    HP_TRACE_WRITE = 1,    /**< The block is modified (insert, header update) */
+    HP_TRACE_SCAN = 2,     /**< Part of a sequential scan (iterator, export, copy) */
+    HP_TRACE_ALLOCATE = 4, /**< New block appended to the file */
+    HP_TRACE_OPEN = 8,     /**< File opened; block_num holds a hash of the file name */
+    HP_TRACE_CLOSE = 16    /**< File closed and its blocks dropped from the buffer; block_num is 0 */
+} HeapFileTraceFlags;
+
+/**
+ * @brief Header of a block-access trace file, followed by HeapFileTraceEntry records
+ */
+typedef struct HeapFileTraceHeader {
+    char magic[4];
+    unsigned short version;
+    unsigned short entry_size;
+} HeapFileTraceHeader;
+
+/**
+ * @brief One block request made by the HP layer
+ */
+typedef struct HeapFileTraceEntry {
+    unsigned int block_num;      /**< Requested block (name hash for HP_TRACE_OPEN, 0 for HP_TRACE_CLOSE) */
+    unsigned short file_handle;  /**< BF file handle of the open instance */
+    unsigned char flags;         /**< HeapFileTraceFlags */
+    unsigned char reserved;
+} HeapFileTraceEntry;
+
+#ifdef __cplusplus
+}
+#endif
 #endif /* HP_FILE_STRUCTS_H */
@@ -1,6 +1,10 @@
 #ifndef RECORD_H
 #define RECORD_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 
 
@@ -22,4 +26,7 @@ Record randomRecord();
 
 void printRecord(Record record);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
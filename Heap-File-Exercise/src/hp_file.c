@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stddef.h>
 #include "bf.h"
 #include "hp_file_structs.h"
 #include "record.h"
@@ -16,8 +19,288 @@
     }                         \
   }
 
+// megethos tou buffer eksodou ths HeapFile_Export
+#define HP_EXPORT_BUF_SIZE (1 << 20)
+
+/* -------------------------------------------------------------------------- */
+/*                               Instrumentation                              */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Oles oi klhseis tou BF pernane apo ta hp_* parakatw. Me -DHP_METRICS
+ * metrame klhseis kai pins, kai me -DHP_METRICS_TIMING kai kyklous rdtsc ana
+ * klhsh. Xwris HP_METRICS ta wrappers einai apla klhseis tou BF kai ta HP_COUNT /
+ * HP_OP den paragoun kwdika.
+ */
+#ifdef HP_METRICS
+
+#ifdef HP_METRICS_TIMING
+#if !defined(__x86_64__) && !defined(__i386__)
+#error "HP_METRICS_TIMING needs rdtsc (x86)"
+#endif
+#include <x86intrin.h>
+// BF_GetBlock pio argo apo tosous kyklous shmainei oti to block diavastike apo to disko
+#ifndef HP_METRICS_MISS_CYCLES
+#define HP_METRICS_MISS_CYCLES 1000
+#endif
+#define HP_TSC() __rdtsc()
+#else
+#define HP_TSC() 0ULL
+#endif
+
+static HeapFileMetrics hp_metrics;
+static FILE* hp_metrics_out = NULL;
+static int hp_metrics_json = 0;
+static unsigned long long hp_metrics_every = 0;
+static unsigned long long hp_metrics_ops = 0;
+
+#define HP_COUNT(field) (hp_metrics.field++)
+#define HP_OP(field) (hp_metrics.field++, hp_metrics_tick())
+
+static void hp_metrics_tick()
+{
+  if(hp_metrics_out != NULL && ++hp_metrics_ops % hp_metrics_every == 0)
+    HeapFile_DumpMetrics(hp_metrics_out, hp_metrics_json);
+}
+
+#else
+
+#define HP_COUNT(field) ((void)0)
+#define HP_OP(field) ((void)0)
+
+#endif /* HP_METRICS */
+
+/* -------------------------------------------------------------------------- */
+/*                                   Tracing                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Otan trexei HeapFile_TraceStart, kathe aithsh block apo to epipedo HP
+ * katagrafetai san HeapFileTraceEntry (8 bytes) se ena buffer pou grafetai sto
+ * arxeio otan gemisei. Xwris energo trace to kostos einai enas elegxos NULL.
+ */
+#define HP_TRACE_BUF_ENTRIES 4096
+
+// syndyasmoi twn HeapFileTraceFlags pou xrhsimopoioun ta wrappers
+#define HP_READ_POINT 0
+#define HP_READ_SCAN HP_TRACE_SCAN
+#define HP_WRITE_POINT HP_TRACE_WRITE
+
+static FILE* hp_trace_file = NULL;
+static HeapFileTraceEntry hp_trace_buf[HP_TRACE_BUF_ENTRIES];
+static int hp_trace_len = 0;
+static int hp_trace_error = 0; // kapoio flush apetyxe, to trace einai ellipes
+
+static int hp_trace_flush()
+{
+  int ok = fwrite(hp_trace_buf, sizeof(HeapFileTraceEntry), hp_trace_len, hp_trace_file) == (size_t)hp_trace_len;
+  hp_trace_len = 0;
+  return ok;
+}
+
+static void hp_trace(int file_handle, unsigned int block_num, unsigned int flags)
+{
+  HeapFileTraceEntry *e = &hp_trace_buf[hp_trace_len++];
+  e->block_num = block_num;
+  e->file_handle = (unsigned short)file_handle;
+  e->flags = (unsigned char)flags;
+  e->reserved = 0;
+  if(hp_trace_len == HP_TRACE_BUF_ENTRIES && !hp_trace_flush()) hp_trace_error = 1;
+}
+
+// FNV-1a tou onomatos, wste o simulator na anagnwrizei to idio arxeio se diaforetika handles
+static unsigned int hp_trace_name_hash(const char* name)
+{
+  unsigned int h = 2166136261u;
+  for(; *name; name++){
+      h ^= (unsigned char)*name;
+      h *= 16777619u;
+  }
+  return h;
+}
+
+int HeapFile_TraceStart(const char* path)
+{
+  if(hp_trace_file != NULL) return 0;
+  hp_trace_file = fopen(path, "wb");
+  if(hp_trace_file == NULL) return 0;
+  HeapFileTraceHeader header;
+  memcpy(header.magic, HP_TRACE_MAGIC, sizeof(header.magic));
+  header.version = HP_TRACE_VERSION;
+  header.entry_size = sizeof(HeapFileTraceEntry);
+  if(fwrite(&header, sizeof(header), 1, hp_trace_file) != 1){
+      fclose(hp_trace_file);
+      hp_trace_file = NULL;
+      return 0;
+  }
+  hp_trace_len = 0;
+  hp_trace_error = 0;
+  return 1;
+}
+
+int HeapFile_TraceStop()
+{
+  if(hp_trace_file == NULL) return 0;
+  int ok = hp_trace_flush() && !hp_trace_error;
+  ok = fclose(hp_trace_file) == 0 && ok;
+  hp_trace_file = NULL;
+  return ok;
+}
+
+static inline BF_ErrorCode hp_open_file(const char* file_name, int *file_handle)
+{
+  BF_ErrorCode code = BF_OpenFile(file_name, file_handle);
+  if(hp_trace_file != NULL && code == BF_OK)
+    hp_trace(*file_handle, hp_trace_name_hash(file_name), HP_TRACE_OPEN);
+  return code;
+}
+
+// to BF_CloseFile vgazei ola ta blocks tou arxeiou apo to buffer
+static inline BF_ErrorCode hp_close_file(int file_handle)
+{
+  BF_ErrorCode code = BF_CloseFile(file_handle);
+  if(hp_trace_file != NULL && code == BF_OK)
+    hp_trace(file_handle, 0, HP_TRACE_CLOSE);
+  return code;
+}
+
+static inline BF_ErrorCode hp_get_block(int file_handle, int block_num, BF_Block *block, unsigned int access)
+{
+  if(hp_trace_file != NULL) hp_trace(file_handle, block_num, access);
+#ifdef HP_METRICS
+  unsigned long long t0 = HP_TSC();
+  BF_ErrorCode code = BF_GetBlock(file_handle, block_num, block);
+  unsigned long long cycles = HP_TSC() - t0;
+  hp_metrics.get_block_calls++;
+  hp_metrics.pages_pinned += code == BF_OK;
+#ifdef HP_METRICS_TIMING
+  hp_metrics.get_block_cycles += cycles;
+  if(cycles < HP_METRICS_MISS_CYCLES) hp_metrics.buffer_hits++;
+  else hp_metrics.buffer_misses++;
+#else
+  (void)cycles;
+#endif
+  return code;
+#else
+  return BF_GetBlock(file_handle, block_num, block);
+#endif
+}
+
+static inline BF_ErrorCode hp_allocate_block(int file_handle, BF_Block *block)
+{
+#ifdef HP_METRICS
+  unsigned long long t0 = HP_TSC();
+  BF_ErrorCode code = BF_AllocateBlock(file_handle, block);
+  hp_metrics.allocate_block_cycles += HP_TSC() - t0;
+  hp_metrics.allocate_block_calls++;
+  hp_metrics.pages_pinned += code == BF_OK;
+#else
+  BF_ErrorCode code = BF_AllocateBlock(file_handle, block);
+#endif
+  // to neo block einai panta to teleutaio tou arxeiou
+  int blocks_num;
+  if(hp_trace_file != NULL && code == BF_OK && BF_GetBlockCounter(file_handle, &blocks_num) == BF_OK)
+    hp_trace(file_handle, blocks_num - 1, HP_TRACE_WRITE | HP_TRACE_ALLOCATE);
+  return code;
+}
+
+static inline BF_ErrorCode hp_unpin_block(BF_Block *block)
+{
+#ifdef HP_METRICS
+  unsigned long long t0 = HP_TSC();
+  BF_ErrorCode code = BF_UnpinBlock(block);
+  hp_metrics.unpin_cycles += HP_TSC() - t0;
+  hp_metrics.unpin_calls++;
+  return code;
+#else
+  return BF_UnpinBlock(block);
+#endif
+}
+
+static inline void hp_set_dirty(BF_Block *block)
+{
+  HP_COUNT(set_dirty_calls);
+  BF_Block_SetDirty(block);
+}
+
+int HeapFile_GetMetrics(HeapFileMetrics *metrics)
+{
+#ifdef HP_METRICS
+  *metrics = hp_metrics;
+  return 1;
+#else
+  memset(metrics, 0, sizeof(*metrics));
+  return 0;
+#endif
+}
+
+void HeapFile_ResetMetrics()
+{
+#ifdef HP_METRICS
+  memset(&hp_metrics, 0, sizeof(hp_metrics));
+  hp_metrics_ops = 0;
+#endif
+}
+
+int HeapFile_SetMetricsDump(FILE *out, int json, unsigned long long every_ops)
+{
+#ifdef HP_METRICS
+  hp_metrics_out = every_ops > 0 ? out : NULL;
+  hp_metrics_json = json;
+  hp_metrics_every = every_ops;
+  hp_metrics_ops = 0;
+  return 1;
+#else
+  (void)out; (void)json; (void)every_ops;
+  return 0;
+#endif
+}
+
+// onomata kai offsets twn pediwn tou HeapFileMetrics, me th seira tou struct
+#define HP_METRIC_FIELD(name) { #name, offsetof(HeapFileMetrics, name) }
+static const struct { const char* name; size_t offset; } hp_metric_fields[] = {
+  HP_METRIC_FIELD(op_create),
+  HP_METRIC_FIELD(op_open),
+  HP_METRIC_FIELD(op_close),
+  HP_METRIC_FIELD(op_insert),
+  HP_METRIC_FIELD(op_insert_batch),
+  HP_METRIC_FIELD(op_next_record),
+  HP_METRIC_FIELD(op_export),
+  HP_METRIC_FIELD(op_copy),
+  HP_METRIC_FIELD(op_snapshot),
+  HP_METRIC_FIELD(op_next_snapshot_record),
+  HP_METRIC_FIELD(get_block_calls),
+  HP_METRIC_FIELD(allocate_block_calls),
+  HP_METRIC_FIELD(unpin_calls),
+  HP_METRIC_FIELD(set_dirty_calls),
+  HP_METRIC_FIELD(pages_pinned),
+  HP_METRIC_FIELD(dirty_on_read),
+  HP_METRIC_FIELD(header_writes),
+  HP_METRIC_FIELD(buffer_hits),
+  HP_METRIC_FIELD(buffer_misses),
+  HP_METRIC_FIELD(get_block_cycles),
+  HP_METRIC_FIELD(allocate_block_cycles),
+  HP_METRIC_FIELD(unpin_cycles),
+};
+
+void HeapFile_DumpMetrics(FILE *out, int json)
+{
+  HeapFileMetrics m;
+  HeapFile_GetMetrics(&m);
+  int n = sizeof(hp_metric_fields) / sizeof(hp_metric_fields[0]);
+  if(json) fputc('{', out);
+  for(int i = 0; i < n; i++){
+      unsigned long long v = *(const unsigned long long*)((const char*)&m + hp_metric_fields[i].offset);
+      if(json) fprintf(out, "%s\"%s\": %llu", i ? ", " : "", hp_metric_fields[i].name, v);
+      else fprintf(out, "%-22s %llu\n", hp_metric_fields[i].name, v);
+  }
+  if(json) fputs("}\n", out);
+  fflush(out);
+}
+
 int HeapFile_Create(const char* fileName)
 {
+  HP_OP(op_create);
   int filehandler;
   
   // Δημιουργούμε νέο αρχείο blocks καλώντας μέσω της CALL_BF για έλεγχο λαθών
@@ -25,13 +308,13 @@ int HeapFile_Create(const char* fileName)
 
   //Ανοίγουμε το αρχείο που δημιουργήσαμε και αποθηκεύουμε τον χειρηστή στη μεταβλητή filehandler
   //πάλι με CALL_BF για έλεγχο πιθανών λαθών κατά το άνοιγμα
-  CALL_BF(BF_OpenFile(fileName, &filehandler));
+  CALL_BF(hp_open_file(fileName, &filehandler));
 
   //Δημιουργουμε το πρώτο Block για να αποθηκευσουμε εκεί το header του heap
   BF_Block *headerblock;
   BF_Block_Init(&headerblock); //δημιουργια του μπλοκ
 
-  CALL_BF(BF_AllocateBlock(filehandler, headerblock)); // ενταξη του στο heap
+  CALL_BF(hp_allocate_block(filehandler, headerblock)); // ενταξη του στο heap
   
   //παιρνουμε pointer στα data του μπλοκ για να κανουμε αρχικοποιηση των δεδομενων του header
   char* tmp = BF_Block_GetData(headerblock);
@@ -42,19 +325,21 @@ int HeapFile_Create(const char* fileName)
   
   //το block γινεται dirty αφου υπέστη αλλαγες
   //και υστερα unpin  αφου ολοκληρώσαμε τις διεργασιες, για να αποθηκευτουν οι αλλαγες στο αρχειο
-  BF_Block_SetDirty(headerblock);
-  CALL_BF(BF_UnpinBlock(headerblock));
+  hp_set_dirty(headerblock);
+  HP_COUNT(header_writes);
+  CALL_BF(hp_unpin_block(headerblock));
 
   //απελευθέρωση του μπλοκ απο την μνήμη αφού εχει αποθηκευτει
-  BF_BlSock_Destroy(&headerblock);
+  BF_Block_Destroy(&headerblock);
 
   //κλείσιμο του ααρχείου
-  CALL_BF(BF_CloseFile(filehandler));
+  CALL_BF(hp_close_file(filehandler));
   return 1;
 }
 
 int HeapFile_Open(const char *fileName, int *file_handle, HeapFileHeader** header_info)
 {
+  HP_OP(op_open);
 
 void* data ;
 BF_Block *block;          // arxikopoiw to block
@@ -62,9 +347,9 @@ BF_Block_Init(&block);
 HeapFileHeader* header;    // arxikopoiw to header pointer
 
 
-  CALL_BF(BF_OpenFile(fileName, file_handle));  //anoigma arxeiou kai apothikeusi tou file handle
+  CALL_BF(hp_open_file(fileName, file_handle));  //anoigma arxeiou kai apothikeusi tou file handle
 
-  CALL_BF(BF_GetBlock(*file_handle,0,block));   //pairnw to prwto block pou periexei to header
+  CALL_BF(hp_get_block(*file_handle,0,block,HP_READ_POINT));   //pairnw to prwto block pou periexei to header
 
   data = BF_Block_GetData(block);                   //pairnw ta dedomena tou block
 
@@ -73,14 +358,14 @@ HeapFileHeader* header;    // arxikopoiw to header pointer
   memcpy(header, data, sizeof(HeapFileHeader)); //antigrafo ta dedomena apo to block sto header
   
   if(strcmp(header->file_type,"heap") != 0){ //elegxw an einai heap file
-      CALL_BF(BF_UnpinBlock(block));           // an den einai heap file, kanw unpin to block,
+      CALL_BF(hp_unpin_block(block));           // an den einai heap file, kanw unpin to block,
       BF_Block_Destroy(&block);          // apodesmeyw to block
       free(header);               // apodesmeyw to header 
     return 0; // den einai heap file
   }
   
   //an ftasei edw simainei oti einai heap file kai akolouthw idia diadikasia apodesmeyshs
-  CALL_BF(BF_UnpinBlock(block));
+  CALL_BF(hp_unpin_block(block));
   BF_Block_Destroy(&block);
 
   *header_info = header;
@@ -89,20 +374,22 @@ HeapFileHeader* header;    // arxikopoiw to header pointer
 
 int HeapFile_Close(int file_handle, HeapFileHeader *hp_info)
 {
+  HP_OP(op_close);
 
   free(hp_info); // απελευθερωση του header απο τη μνημη (για τη malloc που ειχε γινει στην open)
-  CALL_BF(BF_CloseFile(file_handle)); // κλεισιμο του αρχειου, επιστρεφει 0 αν ειχε μεινει καποιο block pinned
+  CALL_BF(hp_close_file(file_handle)); // κλεισιμο του αρχειου, επιστρεφει 0 αν ειχε μεινει καποιο block pinned
   return 1;
 }
 
 int HeapFile_InsertRecord(int file_handle, HeapFileHeader *hp_info, const Record record)
 {   
+  HP_OP(op_insert);
   //periptwsh poy to heap file den exei kanena block dedomenwn
   if(hp_info->blocks_num == 1 && hp_info->currentblockid == -1){
       // dhmiourgia tou prwtou block dedomenwn
       BF_Block *new_block;
       BF_Block_Init(&new_block);
-      CALL_BF(BF_AllocateBlock(file_handle, new_block));
+      CALL_BF(hp_allocate_block(file_handle, new_block));
       char* new_data = BF_Block_GetData(new_block);
       // eisagwgh eggrafhs sto neo block
       Record* rec_ptr = (Record*)(new_data);
@@ -113,18 +400,19 @@ int HeapFile_InsertRecord(int file_handle, HeapFileHeader *hp_info, const Record
       new_mdata->next_block_id = -1; // arxika den yparxei epomeno block
       hp_info->currentblockid = 1; // allagh tou current block id sto epomeno block
       hp_info->blocks_num += 1; // auxisi tou arithmou twn blocks sto header
-      BF_Block_SetDirty(new_block);
-      CALL_BF(BF_UnpinBlock(new_block));
+      hp_set_dirty(new_block);
+      CALL_BF(hp_unpin_block(new_block));
       BF_Block_Destroy(&new_block);
 
       // Ενημέρωση header block
       BF_Block *header_block;
       BF_Block_Init(&header_block);
-      CALL_BF(BF_GetBlock(file_handle, 0, header_block));
+      CALL_BF(hp_get_block(file_handle, 0, header_block, HP_WRITE_POINT));
       char* header_data = BF_Block_GetData(header_block);
       memcpy(header_data, hp_info, sizeof(HeapFileHeader));
-      BF_Block_SetDirty(header_block);
-      CALL_BF(BF_UnpinBlock(header_block));
+      hp_set_dirty(header_block);
+      HP_COUNT(header_writes);
+      CALL_BF(hp_unpin_block(header_block));
       BF_Block_Destroy(&header_block);
 
       return 1;
@@ -133,7 +421,7 @@ int HeapFile_InsertRecord(int file_handle, HeapFileHeader *hp_info, const Record
 
 BF_Block *block;
 BF_Block_Init(&block);
-CALL_BF(BF_GetBlock(file_handle, hp_info->currentblockid, block));
+CALL_BF(hp_get_block(file_handle, hp_info->currentblockid, block, HP_WRITE_POINT));
 char* data = BF_Block_GetData(block);
 
 
@@ -148,31 +436,32 @@ int max_records = (BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata)) / sizeof(Recor
       memcpy(rec_ptr, &record, sizeof(Record));
       mdata->record_count += 1;
       
-      BF_Block_SetDirty(block);
-      CALL_BF(BF_UnpinBlock(block));
+      hp_set_dirty(block);
+      CALL_BF(hp_unpin_block(block));
       BF_Block_Destroy(&block);
 
       // Ενημέρωση header block
       BF_Block *header_block;
       BF_Block_Init(&header_block);
-      CALL_BF(BF_GetBlock(file_handle, 0, header_block));
+      CALL_BF(hp_get_block(file_handle, 0, header_block, HP_WRITE_POINT));
       char* header_data = BF_Block_GetData(header_block);
       memcpy(header_data, hp_info, sizeof(HeapFileHeader));
-      BF_Block_SetDirty(header_block);
-      CALL_BF(BF_UnpinBlock(header_block));
+      hp_set_dirty(header_block);
+      HP_COUNT(header_writes);
+      CALL_BF(hp_unpin_block(header_block));
       BF_Block_Destroy(&header_block);
 
       return 1;
   }
   if(max_records - mdata->record_count ==0 ){
       // to block einai gemato, prepei na dhmiourghthei neo block
-      BF_Block_SetDirty(block);
-      CALL_BF(BF_UnpinBlock(block));
+      hp_set_dirty(block);
+      CALL_BF(hp_unpin_block(block));
       BF_Block_Destroy(&block);
       // dhmiourgia neou block
       BF_Block *new_block;
       BF_Block_Init(&new_block);
-      CALL_BF(BF_AllocateBlock(file_handle, new_block));
+      CALL_BF(hp_allocate_block(file_handle, new_block));
       char* new_data = BF_Block_GetData(new_block);
       // eisagwgh eggrafhs sto neo block
       Record* rec_ptr = (Record*)(new_data);
@@ -183,25 +472,26 @@ int max_records = (BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata)) / sizeof(Recor
       new_mdata->next_block_id = -1; // arxika den yparxei epomeno block
       hp_info->currentblockid += 1; // allagh tou current block id sto epomeno block
       hp_info->blocks_num += 1; // auxisi tou arithmou twn blocks sto header
-      BF_Block_SetDirty(new_block);
-      CALL_BF(BF_UnpinBlock(new_block));
+      hp_set_dirty(new_block);
+      CALL_BF(hp_unpin_block(new_block));
       BF_Block_Destroy(&new_block);
 
       // Ενημέρωση header block
       BF_Block *header_block;
       BF_Block_Init(&header_block);
-      CALL_BF(BF_GetBlock(file_handle, 0, header_block));
+      CALL_BF(hp_get_block(file_handle, 0, header_block, HP_WRITE_POINT));
       char* header_data = BF_Block_GetData(header_block);
       memcpy(header_data, hp_info, sizeof(HeapFileHeader));
-      BF_Block_SetDirty(header_block);
-      CALL_BF(BF_UnpinBlock(header_block));
+      hp_set_dirty(header_block);
+      HP_COUNT(header_writes);
+      CALL_BF(hp_unpin_block(header_block));
       BF_Block_Destroy(&header_block);
 
       return 1;
     }
   else{
       // kapoio sfalma
-      CALL_BF(BF_UnpinBlock(block));
+      CALL_BF(hp_unpin_block(block));
       BF_Block_Destroy(&block);
       return 0;
     }
@@ -223,11 +513,12 @@ HeapFileIterator HeapFile_CreateIterator(    int file_handle, HeapFileHeader* he
 
 int HeapFile_GetNextRecord(    HeapFileIterator* heap_iterator, Record** record)
 {
+  HP_OP(op_next_record);
 
   while(heap_iterator->current_block < heap_iterator->header_info->blocks_num){
       BF_Block *block;
       BF_Block_Init(&block);
-      CALL_BF(BF_GetBlock(heap_iterator->file_handle, heap_iterator->current_block, block));
+      CALL_BF(hp_get_block(heap_iterator->file_handle, heap_iterator->current_block, block, HP_READ_SCAN));
       char* data = BF_Block_GetData(block);
       HeapFileBlockMetadata *mdata = (HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
       while(heap_iterator->current_record <= mdata->record_count){
@@ -236,8 +527,9 @@ int HeapFile_GetNextRecord(    HeapFileIterator* heap_iterator, Record** record)
               *record = malloc(sizeof(Record));
               memcpy(*record, rec_ptr, sizeof(Record));
               heap_iterator->current_record += 1;
-              BF_Block_SetDirty(block);
-              CALL_BF(BF_UnpinBlock(block));
+              hp_set_dirty(block);
+              HP_COUNT(dirty_on_read);
+              CALL_BF(hp_unpin_block(block));
               BF_Block_Destroy(&block);
               return 1;
           }
@@ -245,7 +537,7 @@ int HeapFile_GetNextRecord(    HeapFileIterator* heap_iterator, Record** record)
       }
          heap_iterator->current_block += 1;
          heap_iterator->current_record = 1;
-        CALL_BF(BF_UnpinBlock(block));
+        CALL_BF(hp_unpin_block(block));
         BF_Block_Destroy(&block);
   }
 
@@ -257,3 +549,346 @@ int HeapFile_GetNextRecord(    HeapFileIterator* heap_iterator, Record** record)
   // me afti tin ilopoihsh den borw na kanw free to record mes sth sunartisi. prepei na to kanei o kalwntas
 }
 
+int HeapFile_InsertRecords(int file_handle, HeapFileHeader *hp_info, const Record *records, int count)
+{
+  HP_OP(op_insert_batch);
+  BF_Block *block;
+  BF_Block_Init(&block);
+  char* data = NULL;
+  HeapFileBlockMetadata *mdata = NULL;
+  int dirty = 0;
+  int i = 0;
+
+  // an yparxei hdh block dedomenwn, synexizoume to gemisma apo to teleutaio
+  if(hp_info->currentblockid != -1 && count > 0){
+      CALL_BF(hp_get_block(file_handle, hp_info->currentblockid, block, HP_WRITE_POINT));
+      data = BF_Block_GetData(block);
+      mdata = (HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+  }
+
+  while(i < count){
+      if(mdata == NULL || mdata->record_count == HP_RECORDS_PER_BLOCK){
+          // to trexon block gemise (h den yparxei), to afhnoume kai desmeyoume neo sto telos
+          if(mdata != NULL){
+              if(dirty) hp_set_dirty(block);
+              CALL_BF(hp_unpin_block(block));
+          }
+          CALL_BF(hp_allocate_block(file_handle, block));
+          data = BF_Block_GetData(block);
+          mdata = (HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+          mdata->record_count = 0;
+          mdata->next_block_id = -1;
+          // to neo block einai to teleutaio tou arxeiou, akoma kai an to header sto disko
+          // emeine pisw (p.x. apo import pou skotwthike prin to HeapFile_FlushHeader)
+          int blocks_num;
+          CALL_BF(BF_GetBlockCounter(file_handle, &blocks_num));
+          hp_info->currentblockid = blocks_num - 1;
+          hp_info->blocks_num = blocks_num;
+      }
+      // antigrafoume osa xwrane me mia memcpy anti gia mia-mia tis eggrafes
+      int n = HP_RECORDS_PER_BLOCK - mdata->record_count;
+      if(n > count - i) n = count - i;
+      memcpy(data + mdata->record_count * sizeof(Record), &records[i], n * sizeof(Record));
+      mdata->record_count += n;
+      dirty = 1;
+      i += n;
+  }
+
+  if(mdata != NULL){
+      if(dirty) hp_set_dirty(block);
+      CALL_BF(hp_unpin_block(block));
+  }
+  BF_Block_Destroy(&block);
+  // to header DEN grafetai edw, o kalwn kanei HeapFile_FlushHeader otan teleiwsei
+  return 1;
+}
+
+int HeapFile_FlushHeader(int file_handle, HeapFileHeader *hp_info)
+{
+  BF_Block *header_block;
+  BF_Block_Init(&header_block);
+  CALL_BF(hp_get_block(file_handle, 0, header_block, HP_WRITE_POINT));
+  char* header_data = BF_Block_GetData(header_block);
+  memcpy(header_data, hp_info, sizeof(HeapFileHeader));
+  hp_set_dirty(header_block);
+  HP_COUNT(header_writes);
+  CALL_BF(hp_unpin_block(header_block));
+  BF_Block_Destroy(&header_block);
+  return 1;
+}
+
+// grafei olo to [buf, buf+len) sto fd, synexizontas meta apo merika write
+static int write_all(int fd, const char* buf, size_t len)
+{
+  while(len > 0){
+      ssize_t n = write(fd, buf, len);
+      if(n < 0){
+          if(errno == EINTR) continue;
+          return 0;
+      }
+      buf += n;
+      len -= n;
+  }
+  return 1;
+}
+
+// akeraios se dekadiko, xwris printf. Epistrefei to telos tou keimenou
+static char* format_int(char* out, int value)
+{
+  char tmp[12];
+  int n = 0;
+  unsigned int v = value < 0 ? -(unsigned int)value : (unsigned int)value;
+  do{
+      tmp[n++] = '0' + v % 10;
+      v /= 10;
+  }while(v > 0);
+  if(value < 0) *out++ = '-';
+  while(n > 0) *out++ = tmp[--n];
+  return out;
+}
+
+// pedio string statherou megethous, pou mporei na mhn exei '\0' an einai gemato.
+// Opws sto RFC 4180, pedio me ',', '"' h allagh grammhs grafetai se eisagwgika me to '"' diplo
+static char* format_field(char* out, const char* field, size_t size)
+{
+  const char* end = memchr(field, '\0', size);
+  size_t n = end ? (size_t)(end - field) : size;
+  size_t i = 0;
+  while(i < n && field[i] != ',' && field[i] != '"' && field[i] != '\n' && field[i] != '\r') i++;
+  if(i == n){
+      memcpy(out, field, n);
+      return out + n;
+  }
+  *out++ = '"';
+  for(i = 0; i < n; i++){
+      if(field[i] == '"') *out++ = '"';
+      *out++ = field[i];
+  }
+  *out++ = '"';
+  return out;
+}
+
+static char* format_csv(char* out, const Record* rec)
+{
+  out = format_int(out, rec->id);
+  *out++ = ',';
+  out = format_field(out, rec->name, sizeof(rec->name));
+  *out++ = ',';
+  out = format_field(out, rec->surname, sizeof(rec->surname));
+  *out++ = ',';
+  out = format_field(out, rec->city, sizeof(rec->city));
+  *out++ = '\n';
+  return out;
+}
+
+long long HeapFile_Export(int file_handle, HeapFileHeader *hp_info, int fd, HeapFileExportFormat format, int search_id)
+{
+  HP_OP(op_export);
+  // mia grammh CSV xwraei panta se 2 * sizeof(Record) + 16 bytes (diplasiasmena '"',
+  // eisagwgika, arithmos, kommata, '\n')
+  const size_t max_line = 2 * sizeof(Record) + 16;
+  char* buf = malloc(HP_EXPORT_BUF_SIZE);
+  if(buf == NULL) return -1;
+  size_t len = 0;
+  long long written = 0;
+  int blocks_num = hp_info->blocks_num;
+
+  BF_Block *block;
+  BF_Block_Init(&block);
+  for(int b = 1; b < blocks_num; b++){
+      BF_ErrorCode code = hp_get_block(file_handle, b, block, HP_READ_SCAN);
+      if(code != BF_OK){
+          BF_PrintError(code);
+          BF_Block_Destroy(&block);
+          free(buf);
+          return -1;
+      }
+      const char* data = BF_Block_GetData(block);
+      const HeapFileBlockMetadata *mdata = (const HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+      const Record* recs = (const Record*)data;
+      int count = mdata->record_count;
+
+      if(format == HP_EXPORT_BINARY && search_id == -1){
+          // oloklhro to block me mia memcpy
+          size_t n = count * sizeof(Record);
+          if(len + n > HP_EXPORT_BUF_SIZE){
+              if(!write_all(fd, buf, len)) goto fail;
+              len = 0;
+          }
+          memcpy(buf + len, recs, n);
+          len += n;
+          written += count;
+      }
+      else{
+          for(int i = 0; i < count; i++){
+              if(search_id != -1 && recs[i].id != search_id) continue;
+              if(len + max_line > HP_EXPORT_BUF_SIZE){
+                  if(!write_all(fd, buf, len)) goto fail;
+                  len = 0;
+              }
+              if(format == HP_EXPORT_BINARY){
+                  memcpy(buf + len, &recs[i], sizeof(Record));
+                  len += sizeof(Record);
+              }
+              else{
+                  len = format_csv(buf + len, &recs[i]) - buf;
+              }
+              written++;
+          }
+      }
+      // mono anagnwsh, to block den ginetai dirty
+      code = hp_unpin_block(block);
+      if(code != BF_OK){
+          BF_PrintError(code);
+          BF_Block_Destroy(&block);
+          free(buf);
+          return -1;
+      }
+  }
+  BF_Block_Destroy(&block);
+
+  if(len > 0 && !write_all(fd, buf, len)){
+      free(buf);
+      return -1;
+  }
+  free(buf);
+  return written;
+
+fail:
+  hp_unpin_block(block);
+  BF_Block_Destroy(&block);
+  free(buf);
+  return -1;
+}
+
+int HeapFile_Copy(int file_handle, HeapFileHeader *hp_info, const char* dst_file_name)
+{
+  HP_OP(op_copy);
+  if(!HeapFile_Create(dst_file_name)) return -1;
+
+  int dst_handle;
+  BF_ErrorCode code = hp_open_file(dst_file_name, &dst_handle);
+  if(code != BF_OK){
+      BF_PrintError(code);
+      return -1;
+  }
+
+  HeapFileHeader dst_info = *hp_info;
+  dst_info.blocks_num = 1;
+  dst_info.currentblockid = -1;
+
+  int ok = 0;
+  int src_pinned = 0;
+  int dst_pinned = 0;
+  BF_Block *src_block;
+  BF_Block *dst_block;
+  BF_Block_Init(&src_block);
+  BF_Block_Init(&dst_block);
+  for(int b = 1; b < hp_info->blocks_num; b++){
+      if((code = hp_get_block(file_handle, b, src_block, HP_READ_SCAN)) != BF_OK) goto cleanup;
+      src_pinned = 1;
+      const char* src_data = BF_Block_GetData(src_block);
+      const HeapFileBlockMetadata *mdata = (const HeapFileBlockMetadata*)(src_data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+      if(mdata->record_count > 0){
+          // to block antigrafetai autousio, mazi me ta metadata tou
+          if((code = hp_allocate_block(dst_handle, dst_block)) != BF_OK) goto cleanup;
+          dst_pinned = 1;
+          memcpy(BF_Block_GetData(dst_block), src_data, BF_BLOCK_SIZE);
+          hp_set_dirty(dst_block);
+          dst_pinned = 0;
+          if((code = hp_unpin_block(dst_block)) != BF_OK) goto cleanup;
+          dst_info.currentblockid = dst_info.blocks_num;
+          dst_info.blocks_num += 1;
+      }
+      src_pinned = 0;
+      if((code = hp_unpin_block(src_block)) != BF_OK) goto cleanup;
+  }
+  ok = HeapFile_FlushHeader(dst_handle, &dst_info);
+
+cleanup:
+  if(code != BF_OK) BF_PrintError(code);
+  if(src_pinned) hp_unpin_block(src_block);
+  if(dst_pinned) hp_unpin_block(dst_block);
+  BF_Block_Destroy(&src_block);
+  BF_Block_Destroy(&dst_block);
+  code = hp_close_file(dst_handle);
+  if(code != BF_OK){
+      BF_PrintError(code);
+      ok = 0;
+  }
+  // to plithos twn blocks dedomenwn tou neou arxeiou
+  return ok ? dst_info.blocks_num - 1 : -1;
+}
+
+int HeapFile_CreateSnapshotIterator(int file_handle, HeapFileHeader *hp_info, int search_id, HeapFileSnapshotIterator *iterator)
+{
+  HP_OP(op_snapshot);
+  iterator->file_handle = file_handle;
+  iterator->search_id = search_id;
+  iterator->blocks_num = hp_info->blocks_num;
+  iterator->tail_block = -1;
+  iterator->tail_count = 0;
+  iterator->current_block = 1;
+  iterator->current_record = 0;
+
+  if(hp_info->currentblockid == -1) return 1; // adeio heap file
+
+  // ta gemata blocks den allazoun pia, mono to teleutaio mporei na dexthei eggrafes.
+  // An den einai gemato kratame antigrafo twn eggrafwn tou, wste o writer na synexizei
+  // na grafei sto idio block xwris na vlepoume tis nees eggrafes (kai xwris na to
+  // kratame pinned, pou tha sygkrouotan me to pin tou writer)
+  BF_Block *block;
+  BF_Block_Init(&block);
+  CALL_BF(hp_get_block(file_handle, hp_info->currentblockid, block, HP_READ_POINT));
+  const char* data = BF_Block_GetData(block);
+  const HeapFileBlockMetadata *mdata = (const HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+  if(mdata->record_count < HP_RECORDS_PER_BLOCK){
+      iterator->tail_block = hp_info->currentblockid;
+      iterator->tail_count = mdata->record_count;
+      memcpy(iterator->tail_records, data, mdata->record_count * sizeof(Record));
+  }
+  CALL_BF(hp_unpin_block(block));
+  BF_Block_Destroy(&block);
+  return 1;
+}
+
+int HeapFile_GetNextSnapshotRecord(HeapFileSnapshotIterator *it, Record *record)
+{
+  HP_OP(op_next_snapshot_record);
+  while(it->current_block < it->blocks_num){
+      // to teleutaio block diavazetai apo to antigrafo tou snapshot
+      if(it->current_block == it->tail_block){
+          while(it->current_record < it->tail_count){
+              const Record* rec = &it->tail_records[it->current_record++];
+              if(it->search_id == -1 || rec->id == it->search_id){
+                  *record = *rec;
+                  return 1;
+              }
+          }
+      }
+      else{
+          BF_Block *block;
+          BF_Block_Init(&block);
+          CALL_BF(hp_get_block(it->file_handle, it->current_block, block, HP_READ_SCAN));
+          const char* data = BF_Block_GetData(block);
+          const HeapFileBlockMetadata *mdata = (const HeapFileBlockMetadata*)(data + BF_BLOCK_SIZE - sizeof(HeapFileBlockMetadata));
+          const Record* recs = (const Record*)data;
+          int found = 0;
+          while(it->current_record < mdata->record_count){
+              const Record* rec = &recs[it->current_record++];
+              if(it->search_id == -1 || rec->id == it->search_id){
+                  *record = *rec;
+                  found = 1;
+                  break;
+              }
+          }
+          // mono anagnwsh, xwris SetDirty
+          CALL_BF(hp_unpin_block(block));
+          BF_Block_Destroy(&block);
+          if(found) return 1;
+      }
+      it->current_block += 1;
+      it->current_record = 0;
+  }
+  return 0;
+}